@@ -0,0 +1,729 @@
+// Benchmarks for every LinuxParser reader and a whole System tick, run
+// against synthetic proc trees of 100 to 100k processes, see ProcFixture.
+// Besides time, each benchmark reports per iteration:
+//   allocs       calls to operator new, counted by the instrumentation
+//                (0 when built with MONITOR_INSTRUMENTATION off)
+//   io_syscalls  read and write family syscalls, from /proc/self/io. The
+//                kernel does not count open/close there, the per-pid
+//                readers add two of those per file.
+// The fixtures are written once under $MONITOR_BENCH_ROOT (default
+// /dev/shm/monitor-bench) and reused by later runs.
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "exporter.h"
+#include "frame.h"
+#include "instrumentation.h"
+#include "linux_parser.h"
+#include "ncurses_display.h"
+#include "pid_directory.h"
+#include "proc_file.h"
+#include "proc_fixture.h"
+#include "snapshot.h"
+#include "processor.h"
+#include "system.h"
+
+namespace {
+// ex.: syscr: 9
+long IoSyscalls() {
+  char buffer[512];
+  int fd = ::open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+  ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+  ::close(fd);
+  if (size <= 0) {
+    return 0;
+  }
+  buffer[size] = '\0';
+  long syscalls{0};
+  for (char const* key : {"syscr: ", "syscw: "}) {
+    if (char const* line = std::strstr(buffer, key)) {
+      syscalls += std::atol(line + std::strlen(key));
+    }
+  }
+  return syscalls;
+}
+
+struct Usage {
+  std::size_t allocations;
+  long syscalls;
+
+  static Usage Now() {
+    return {static_cast<std::size_t>(Instrumentation::Now().allocations),
+            IoSyscalls()};
+  }
+};
+
+void Report(benchmark::State& state, Usage const& start, long items = 1) {
+  Usage end = Usage::Now();
+  state.counters["allocs"] =
+      benchmark::Counter(static_cast<double>(end.allocations -
+                                             start.allocations),
+                         benchmark::Counter::kAvgIterations);
+  state.counters["io_syscalls"] = benchmark::Counter(
+      static_cast<double>(end.syscalls - start.syscalls),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * items);
+}
+
+std::string Root() {
+  if (char const* root = std::getenv("MONITOR_BENCH_ROOT")) {
+    return root;
+  }
+  return ::access("/dev/shm", W_OK) == 0 ? "/dev/shm/monitor-bench"
+                                         : "/tmp/monitor-bench";
+}
+
+// DONE: Point LinuxParser at the tree of the given size, writing it first
+// if no earlier run did. Returns its pids.
+std::vector<int> const& Use(long processes) {
+  static std::map<long, std::vector<int>> pids;
+  ProcFixture::Settings settings;
+  settings.root = Root() + "/" + std::to_string(processes);
+  settings.processes = processes;
+  ProcFixture fixture(settings);
+  std::string ready = settings.root + "/ready";
+  if (::access(ready.c_str(), F_OK) != 0) {
+    std::fprintf(stderr, "writing %ld processes to %s\n", processes,
+                 settings.root.c_str());
+    if (!fixture.Create()) {
+      std::perror(settings.root.c_str());
+      std::exit(1);
+    }
+    int fd = ::open(ready.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      std::perror(ready.c_str());
+      std::exit(1);
+    }
+    ::close(fd);
+  }
+  // Every fixture has the same passwd, so the process-wide UserCache that
+  // binds to the first one stays valid
+  LinuxParser::SetRoots(fixture.ProcDirectory(), fixture.PasswordPath());
+  auto found = pids.find(processes);
+  if (found == pids.end()) {
+    found = pids.emplace(processes, LinuxParser::Pids()).first;
+  }
+  return found->second;
+}
+
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+  for (long processes : {100, 1000, 10000, 100000}) {
+    benchmark->Arg(processes);
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+long constexpr kSystemSize{1000};
+
+// System wide readers, their cost does not depend on the process count
+template <typename Read>
+void SystemReader(benchmark::State& state, Read read) {
+  Use(kSystemSize);
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(read());
+  }
+  Report(state, start);
+}
+
+// Per-pid readers, one iteration reads every process once like a tick does
+template <typename Read>
+void PidReader(benchmark::State& state, Read read) {
+  std::vector<int> const& pids = Use(state.range(0));
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    for (int pid : pids) {
+      benchmark::DoNotOptimize(read(pid));
+    }
+  }
+  Report(state, start, pids.size());
+}
+}  // namespace
+
+// Parsing alone, on fixed file contents: the scanner based readers against
+// the istringstream and std::stol readers they replaced. Each pair reads the
+// same fields, the scanner one checks that it gets the same values.
+namespace Stream {
+// /proc/[pid]/stat, the fields a tick uses
+void Stat(std::string const& content, LinuxParser::PidStat& stat) {
+  std::istringstream stream(content);
+  std::vector<std::string> values;
+  std::string token;
+  while (stream >> token) {
+    values.push_back(token);
+  }
+  if (values.size() > 23) {
+    stat.state = values[2][0];
+    stat.ppid = std::stoi(values[3]);
+    stat.utime = std::stol(values[13]);
+    stat.stime = std::stol(values[14]);
+    stat.cutime = std::stol(values[15]);
+    stat.cstime = std::stol(values[16]);
+    stat.num_threads = std::stol(values[19]);
+    stat.starttime = std::stoll(values[21]);
+    stat.vsize = std::stoul(values[22]);
+    stat.rss = std::stol(values[23]);
+  }
+}
+
+// /proc/[pid]/status, token by token like the old Ram() and Uid()
+void Status(std::string const& content, LinuxParser::PidStatus& status) {
+  std::istringstream stream(content);
+  std::string token;
+  int found{0};
+  while (found < 4 && stream >> token) {
+    long* field = token == "Uid:"       ? &status.uid
+                  : token == "VmSize:"  ? &status.vm_size
+                  : token == "VmRSS:"   ? &status.vm_rss
+                  : token == "Threads:" ? &status.threads
+                                        : nullptr;
+    if (field != nullptr && stream >> token) {
+      *field = std::stol(token);
+      ++found;
+    }
+  }
+}
+
+// /proc/meminfo, line by line like the old MemoryUtilization(), stopping
+// once it has the same seven keys as the scanner
+void Memory(std::string const& content, LinuxParser::MemInfo& memory) {
+  std::istringstream stream(content);
+  std::string line, key, value;
+  int found{0};
+  while (found < 7 && std::getline(stream, line)) {
+    std::istringstream linestream(line);
+    if (!(linestream >> key >> value)) continue;
+    long* field = key == "MemTotal:"       ? &memory.total
+                  : key == "MemFree:"      ? &memory.free
+                  : key == "MemAvailable:" ? &memory.available
+                  : key == "Buffers:"      ? &memory.buffers
+                  : key == "Cached:"       ? &memory.cached
+                  : key == "SwapTotal:"    ? &memory.swap_total
+                  : key == "SwapFree:"     ? &memory.swap_free
+                                           : nullptr;
+    if (field != nullptr) {
+      *field = std::stol(value);
+      ++found;
+    }
+  }
+}
+}  // namespace Stream
+
+namespace {
+std::string const kPidStat =
+    "1032 (kaccess) S 1014 1014 1014 0 -1 4194304 2464 25 11 0 2037 2332 0 0 "
+    "20 0 3 0 1984 298430464 3121 18446744073709551615 94680157405184 "
+    "94680157409733 140725716618928 0 0 0 0 0 0 0 0 0 17 6 0 0 52 0 0 "
+    "94680157421016 94680157421584 94680163794944 140725716625949 "
+    "140725716625966 140725716625966 140725716627431 0\n";
+
+std::string const kPidStatus =
+    "Name:\tkworker\n"
+    "Umask:\t0022\n"
+    "State:\tR (running)\n"
+    "Tgid:\t17142\n"
+    "Ngid:\t0\n"
+    "Pid:\t17142\n"
+    "PPid:\t17138\n"
+    "TracerPid:\t0\n"
+    "Uid:\t0\t0\t0\t0\n"
+    "Gid:\t0\t0\t0\t0\n"
+    "FDSize:\t256\n"
+    "Groups:\t \n"
+    "NStgid:\t17142\n"
+    "NSpid:\t17142\n"
+    "NSpgid:\t17142\n"
+    "NSsid:\t17138\n"
+    "Kthread:\t0\n"
+    "VmPeak:\t   12532 kB\n"
+    "VmSize:\t   12532 kB\n"
+    "VmLck:\t       0 kB\n"
+    "VmPin:\t       0 kB\n"
+    "VmHWM:\t    8828 kB\n"
+    "VmRSS:\t    8828 kB\n"
+    "RssAnon:\t    2968 kB\n"
+    "RssFile:\t    5860 kB\n"
+    "RssShmem:\t       0 kB\n"
+    "VmData:\t    4644 kB\n"
+    "VmStk:\t     132 kB\n"
+    "VmExe:\t       4 kB\n"
+    "VmLib:\t    4280 kB\n"
+    "VmPTE:\t      68 kB\n"
+    "VmSwap:\t       0 kB\n"
+    "HugetlbPages:\t       0 kB\n"
+    "CoreDumping:\t0\n"
+    "THP_enabled:\t1\n"
+    "untag_mask:\t0xffffffffffffffff\n"
+    "Threads:\t1\n"
+    "SigQ:\t0/24002\n"
+    "SigPnd:\t0000000000000000\n"
+    "ShdPnd:\t0000000000000000\n"
+    "SigBlk:\t0000000000000000\n"
+    "SigIgn:\t0000000001001000\n"
+    "SigCgt:\t0000000000000002\n"
+    "CapInh:\t0000000000000000\n"
+    "CapPrm:\t000001fffeffffff\n"
+    "CapEff:\t000001fffeffffff\n"
+    "CapBnd:\t000001fffeffffff\n"
+    "CapAmb:\t0000000000000000\n"
+    "NoNewPrivs:\t0\n"
+    "Seccomp:\t0\n"
+    "Seccomp_filters:\t0\n"
+    "Speculation_Store_Bypass:\tthread vulnerable\n"
+    "SpeculationIndirectBranch:\tconditional enabled\n"
+    "Cpus_allowed:\t1\n"
+    "Cpus_allowed_list:\t0\n"
+    "Mems_allowed_list:\t0\n"
+    "voluntary_ctxt_switches:\t17\n"
+    "nonvoluntary_ctxt_switches:\t9\n";
+
+std::string const kMeminfo =
+    "MemTotal:        6158152 kB\n"
+    "MemFree:         2300252 kB\n"
+    "MemAvailable:    3493124 kB\n"
+    "Buffers:          206360 kB\n"
+    "Cached:          2624716 kB\n"
+    "SwapCached:            0 kB\n"
+    "Active:          1574692 kB\n"
+    "Inactive:        1483340 kB\n"
+    "Active(anon):    1044512 kB\n"
+    "Inactive(anon):   765032 kB\n"
+    "Active(file):     530180 kB\n"
+    "Inactive(file):   718308 kB\n"
+    "Unevictable:       13628 kB\n"
+    "Mlocked:           13628 kB\n"
+    "SwapTotal:             0 kB\n"
+    "SwapFree:              0 kB\n"
+    "Zswap:                 0 kB\n"
+    "Zswapped:              0 kB\n"
+    "Dirty:               116 kB\n"
+    "Writeback:             0 kB\n"
+    "AnonPages:        240592 kB\n"
+    "Mapped:           149332 kB\n"
+    "Shmem:           1582588 kB\n"
+    "KReclaimable:     241940 kB\n"
+    "Slab:             731712 kB\n"
+    "SReclaimable:     241940 kB\n"
+    "SUnreclaim:       489772 kB\n"
+    "KernelStack:        1152 kB\n"
+    "PageTables:         2040 kB\n"
+    "SecPageTables:         0 kB\n"
+    "NFS_Unstable:          0 kB\n"
+    "Bounce:                0 kB\n"
+    "WritebackTmp:          0 kB\n"
+    "CommitLimit:     3079076 kB\n"
+    "Committed_AS:    1921432 kB\n"
+    "VmallocTotal:   34359738367 kB\n"
+    "VmallocUsed:       15912 kB\n"
+    "VmallocChunk:          0 kB\n"
+    "Percpu:              320 kB\n"
+    "AnonHugePages:         0 kB\n"
+    "ShmemHugePages:        0 kB\n"
+    "ShmemPmdMapped:        0 kB\n"
+    "FileHugePages:         0 kB\n"
+    "FilePmdMapped:         0 kB\n"
+    "Balloon:               0 kB\n"
+    "HugePages_Total:       0\n"
+    "HugePages_Free:        0\n"
+    "HugePages_Rsvd:        0\n"
+    "HugePages_Surp:        0\n"
+    "Hugepagesize:       2048 kB\n"
+    "Hugetlb:               0 kB\n"
+    "DirectMap4k:       22528 kB\n"
+    "DirectMap2M:     2074624 kB\n"
+    "DirectMap1G:     6291456 kB\n";
+}  // namespace
+
+void BM_ParseStatStream(benchmark::State& state) {
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::PidStat stat;
+    Stream::Stat(kPidStat, stat);
+    benchmark::DoNotOptimize(stat);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseStatStream);
+
+void BM_ParseStat(benchmark::State& state) {
+  LinuxParser::PidStat expected, stat;
+  Stream::Stat(kPidStat, expected);
+  if (!LinuxParser::Stat(kPidStat, stat) || stat.utime != expected.utime ||
+      stat.starttime != expected.starttime || stat.rss != expected.rss) {
+    state.SkipWithError("differs from the stream parser");
+  }
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::Stat(kPidStat, stat);
+    benchmark::DoNotOptimize(stat);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseStat);
+
+void BM_ParseStatusStream(benchmark::State& state) {
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::PidStatus status;
+    Stream::Status(kPidStatus, status);
+    benchmark::DoNotOptimize(status);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseStatusStream);
+
+void BM_ParseStatus(benchmark::State& state) {
+  LinuxParser::PidStatus expected, status;
+  Stream::Status(kPidStatus, expected);
+  LinuxParser::Status(kPidStatus, status);
+  if (status.uid != expected.uid || status.vm_size != expected.vm_size ||
+      status.vm_rss != expected.vm_rss || status.threads != expected.threads) {
+    state.SkipWithError("differs from the stream parser");
+  }
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::Status(kPidStatus, status);
+    benchmark::DoNotOptimize(status);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseStatus);
+
+void BM_ParseMeminfoStream(benchmark::State& state) {
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::MemInfo memory;
+    Stream::Memory(kMeminfo, memory);
+    benchmark::DoNotOptimize(memory);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseMeminfoStream);
+
+void BM_ParseMeminfo(benchmark::State& state) {
+  LinuxParser::MemInfo expected, memory;
+  Stream::Memory(kMeminfo, expected);
+  LinuxParser::Memory(kMeminfo, memory);
+  if (memory.total != expected.total || memory.free != expected.free ||
+      memory.available != expected.available ||
+      memory.swap_free != expected.swap_free) {
+    state.SkipWithError("differs from the stream parser");
+  }
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    LinuxParser::Memory(kMeminfo, memory);
+    benchmark::DoNotOptimize(memory);
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ParseMeminfo);
+
+void BM_MemoryUtilization(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::MemoryUtilization(); });
+}
+BENCHMARK(BM_MemoryUtilization);
+
+void BM_Memory(benchmark::State& state) {
+  Use(kSystemSize);
+  ProcFile file(LinuxParser::ProcDirectory() + LinuxParser::kMeminfoFilename);
+  LinuxParser::MemInfo memory;
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::Memory(file.Read(), memory));
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_Memory);
+
+void BM_UpTime(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::UpTime(); });
+}
+BENCHMARK(BM_UpTime);
+
+void BM_TotalProcesses(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::TotalProcesses(); });
+}
+BENCHMARK(BM_TotalProcesses);
+
+void BM_RunningProcesses(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::RunningProcesses(); });
+}
+BENCHMARK(BM_RunningProcesses);
+
+void BM_OperatingSystem(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::OperatingSystem(); });
+}
+BENCHMARK(BM_OperatingSystem);
+
+void BM_Kernel(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::Kernel(); });
+}
+BENCHMARK(BM_Kernel);
+
+void BM_Stat(benchmark::State& state) {
+  LinuxParser::StatSnapshot snapshot;
+  SystemReader(state, [&] { return LinuxParser::Stat(snapshot); });
+}
+BENCHMARK(BM_Stat);
+
+void BM_CpuUtilization(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::CpuUtilization(); });
+}
+BENCHMARK(BM_CpuUtilization);
+
+void BM_Jiffies(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::Jiffies(); });
+}
+BENCHMARK(BM_Jiffies);
+
+void BM_ActiveJiffies(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::ActiveJiffies(); });
+}
+BENCHMARK(BM_ActiveJiffies);
+
+void BM_IdleJiffies(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::IdleJiffies(); });
+}
+BENCHMARK(BM_IdleJiffies);
+
+void BM_UserName(benchmark::State& state) {
+  SystemReader(state, [] { return LinuxParser::UserName(1010); });
+}
+BENCHMARK(BM_UserName);
+
+void BM_Pids(benchmark::State& state) {
+  Use(state.range(0));
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::Pids());
+  }
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_Pids)->Apply(Sizes);
+
+// What a tick does: the directory stays open and the vector is reused
+void BM_PidDirectory(benchmark::State& state) {
+  Use(state.range(0));
+  PidDirectory directory(LinuxParser::ProcDirectory());
+  std::vector<int> pids;
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    directory.Read(pids, state.range(1) != 0);
+    benchmark::DoNotOptimize(pids.data());
+  }
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_PidDirectory)
+    ->ArgsProduct({{100, 1000, 10000, 100000}, {0, 1}})
+    ->ArgNames({"processes", "sorted"})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_PidStat(benchmark::State& state) {
+  LinuxParser::PidStat stat;
+  PidReader(state, [&](int pid) { return LinuxParser::Stat(pid, stat); });
+}
+BENCHMARK(BM_PidStat)->Apply(Sizes);
+
+void BM_PidActiveJiffies(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::ActiveJiffies(pid); });
+}
+BENCHMARK(BM_PidActiveJiffies)->Apply(Sizes);
+
+void BM_PidUpTime(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::UpTime(pid); });
+}
+BENCHMARK(BM_PidUpTime)->Apply(Sizes);
+
+void BM_Command(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::Command(pid); });
+}
+BENCHMARK(BM_Command)->Apply(Sizes);
+
+void BM_Ram(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::Ram(pid); });
+}
+BENCHMARK(BM_Ram)->Apply(Sizes);
+
+void BM_Uid(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::Uid(pid); });
+}
+BENCHMARK(BM_Uid)->Apply(Sizes);
+
+// Uid, VmSize, VmRSS and Threads from one read
+void BM_PidStatus(benchmark::State& state) {
+  LinuxParser::PidStatus status;
+  PidReader(state,
+            [&](int pid) { return LinuxParser::Status(pid, status); });
+}
+BENCHMARK(BM_PidStatus)->Apply(Sizes);
+
+void BM_User(benchmark::State& state) {
+  PidReader(state, [](int pid) { return LinuxParser::User(pid); });
+}
+BENCHMARK(BM_User)->Apply(Sizes);
+
+// One full tick: system files, every pid, ranking the top rows
+void BM_SystemProcesses(benchmark::State& state) {
+  Use(state.range(0));
+  System system;
+  system.MaxBackoff(1);
+  system.Refresh();
+  system.Processes();
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    system.Refresh();
+    benchmark::DoNotOptimize(system.Processes());
+  }
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_SystemProcesses)->Apply(Sizes)->UseRealTime();
+
+// The same tick once the idle processes backed off, the fixture does not
+// change so only the top rows are read every tick
+void BM_SystemProcessesIdle(benchmark::State& state) {
+  Use(state.range(0));
+  System system;
+  for (unsigned tick = 0; tick <= 2 * ProcessTable::kDefaultMaxBackoff;
+       ++tick) {
+    system.Refresh();
+    system.Processes();
+  }
+  long sampled{0};
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    system.Refresh();
+    benchmark::DoNotOptimize(system.Processes());
+    sampled += system.ProcessesSampled();
+  }
+  state.counters["sampled"] = benchmark::Counter(
+      static_cast<double>(sampled), benchmark::Counter::kAvgIterations);
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_SystemProcessesIdle)->Apply(Sizes)->UseRealTime();
+
+// Ranking alone, it reads the key column and the pids of every process
+void BM_Rank(benchmark::State& state) {
+  Use(state.range(0));
+  System system;
+  system.Refresh();
+  system.Processes();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(system.Rank(10, SortKey::kCpu));
+  }
+  state.SetItemsProcessed(state.iterations() * system.Table().Size());
+}
+BENCHMARK(BM_Rank)->Apply(Sizes);
+
+void BM_ProcessorUtilization(benchmark::State& state) {
+  LinuxParser::CpuTimes times;
+  Processor processor;
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    times.states[LinuxParser::kUser_] += 30;
+    times.states[LinuxParser::kIdle_] += 70;
+    processor.Update(times);
+    benchmark::DoNotOptimize(processor.Utilization());
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ProcessorUtilization);
+
+// Per-core deltas for a machine of range(0) cores
+void BM_ProcessorCores(benchmark::State& state) {
+  LinuxParser::CoreTimes cores;
+  cores.count = state.range(0);
+  for (auto& column : cores.states) {
+    column.assign(cores.count, 0);
+  }
+  Processor processor;
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < cores.count; ++i) {
+      cores.states[LinuxParser::kUser_][i] += i % 10;
+      cores.states[LinuxParser::kIdle_][i] += 10 - i % 10;
+    }
+    processor.Update(cores);
+    benchmark::DoNotOptimize(processor.Cores().data());
+  }
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_ProcessorCores)->Arg(8)->Arg(128)->Arg(256);
+
+void BM_ProgressBar(benchmark::State& state) {
+  float percent{0};
+  char buffer[128];
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NCursesDisplay::ProgressBar(percent, buffer, sizeof(buffer)));
+    percent = percent >= 1 ? 0 : percent + 0.01f;
+  }
+  Report(state, start);
+}
+BENCHMARK(BM_ProgressBar);
+
+// Composing the process box of range(0) rows, without a terminal
+void BM_DisplayProcesses(benchmark::State& state) {
+  std::vector<ProcessRow> rows(state.range(0));
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    rows[i].pid = 1000 + i;
+    rows[i].user = "user" + std::to_string(i % 50);
+    rows[i].cpu = (i % 100) / 100.0f;
+    rows[i].ram = std::to_string(i * 3);
+    rows[i].uptime = i * 61;
+    rows[i].command = "/usr/bin/worker --id " + std::to_string(i);
+  }
+  Frame frame;
+  frame.Resize(state.range(0) + 4, 160);
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    frame.Clear();
+    NCursesDisplay::DisplayProcesses(rows, frame, 0, state.range(0));
+    benchmark::DoNotOptimize(&frame);
+  }
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_DisplayProcesses)->Arg(10)->Arg(50);
+
+// One exporter response body, rendered once per tick however many scrape it
+void BM_ExporterRender(benchmark::State& state) {
+  Snapshot snapshot;
+  snapshot.cores.assign(64, 0.5f);
+  snapshot.memory_info.total = 16 << 20;
+  snapshot.processes.resize(state.range(0));
+  for (std::size_t i = 0; i < snapshot.processes.size(); ++i) {
+    ProcessRow& row = snapshot.processes[i];
+    row.pid = 1000 + i;
+    row.user = "user" + std::to_string(i % 50);
+    row.cpu = (i % 100) / 100.0f;
+    row.rss = i * 3 * 1024;
+    row.ram = std::to_string(i * 3);
+    row.uptime = i * 61;
+    row.command = "/usr/bin/worker --id " + std::to_string(i);
+  }
+  std::string out;
+  Usage start = Usage::Now();
+  for (auto _ : state) {
+    out.clear();
+    Exporter::Render(snapshot, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * out.size());
+  Report(state, start, state.range(0));
+}
+BENCHMARK(BM_ExporterRender)->Arg(10)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,18 @@
+#ifndef BATCH_OUTPUT_H
+#define BATCH_OUTPUT_H
+
+#include <string>
+
+#include "options.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
+
+// Headless mode: snapshots are streamed as text, ncurses is never touched
+namespace BatchOutput {
+int Run(SnapshotSource& source, Options const& options);
+void CsvHeader(unsigned fields, std::string& out);
+void Csv(Snapshot const& snapshot, unsigned fields, std::string& out);
+void JsonLine(Snapshot const& snapshot, unsigned fields, std::string& out);
+};  // namespace BatchOutput
+
+#endif
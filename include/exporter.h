@@ -0,0 +1,64 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "snapshot.h"
+#include "snapshot_source.h"
+
+/*
+Serves snapshots as Prometheus text over HTTP, ex.: for a local scraper
+The address is a port on 127.0.0.1, or the path of a unix socket. Every
+snapshot is rendered once, on the thread that takes it from the source,
+into a complete response that replaces the cached one. Scrapes are answered
+from that cache on a server thread, so any number of them costs no /proc
+read and no rendering.
+*/
+class Exporter {
+ public:
+  explicit Exporter(std::string address);
+  ~Exporter();
+  Exporter(Exporter const&) = delete;
+  Exporter& operator=(Exporter const&) = delete;
+
+  bool Open(std::string& error);
+  // Until the source closes or iterations snapshots were taken, 0 runs on
+  int Serve(SnapshotSource& source, long iterations);
+  static void Render(Snapshot const& snapshot, std::string& out);
+
+ private:
+  static constexpr std::size_t kMaxConnections{64};
+  static constexpr std::size_t kMaxRequest{4096};  // bytes of headers
+  static constexpr std::chrono::seconds kRequestTimeout{5};
+
+  struct Connection {
+    int fd{-1};
+    std::string request = {};
+    std::shared_ptr<std::string const> response = {};  // set once read
+    std::size_t sent{0};
+    std::chrono::steady_clock::time_point opened = {};
+  };
+
+  void Run();
+  void Accept();
+  bool Receive(Connection& connection);
+  bool Send(Connection& connection);
+  std::shared_ptr<std::string const> Respond(std::string_view request) const;
+  void Publish(Snapshot const& snapshot, std::string& body);
+  void Close();
+
+  std::string address_;
+  std::string socket_path_;  // unlinked again on close
+  int listen_fd_{-1};
+  int wake_fd_{-1};  // eventfd, stops the server thread
+  std::shared_ptr<std::string const> response_;  // std::atomic_load/store
+  std::vector<Connection> connections_ = {};     // server thread only
+  std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FIELD_SOURCES_H
+#define FIELD_SOURCES_H
+
+#include "process.h"
+#include "snapshot.h"
+
+/*
+Where each process field comes from and how long a read of it lasts
+Ranking and a user filter ask for their sources on every process, the
+selected columns only on the rows that are shown. /proc/[pid]/stat is read
+for every due process anyway, see ProcessTable, so whatever comes from it
+costs nothing more; every other source is one file read per process.
+*/
+namespace FieldSources {
+enum Source : unsigned {
+  kNone = 0,
+  kStat = 1 << 0,     // /proc/[pid]/stat
+  kStatus = 1 << 1,   // /proc/[pid]/status, the uid for a passwd lookup
+  kCmdline = 1 << 2,  // /proc/[pid]/cmdline
+};
+
+// A kTick field is read again every tick, a kProcess one once per process
+enum class Lifetime { kTick, kProcess };
+
+struct Entry {
+  unsigned field;  // see Field
+  Source source;
+  Lifetime lifetime;
+};
+
+inline constexpr Entry kEntries[] = {
+    {kPidField, kNone, Lifetime::kProcess},
+    {kUserField, kStatus, Lifetime::kProcess},
+    {kCpuField, kStat, Lifetime::kTick},
+    {kRamField, kStat, Lifetime::kTick},  // rss
+    {kTimeField, kStat, Lifetime::kTick},
+    {kCommandField, kCmdline, Lifetime::kProcess},
+};
+
+// Sources of these fields, leaving out the kProcess ones already loaded
+unsigned Sources(unsigned fields, unsigned loaded = 0);
+// Sources the ranking by key reads on every process
+unsigned Sources(SortKey key);
+}  // namespace FieldSources
+
+#endif
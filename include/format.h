@@ -1,10 +1,12 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <cstddef>
 #include <string>
 
 namespace Format {
 std::string ElapsedTime(long times);  // See src/format.cpp
-};                                    // namespace Format
+int ElapsedTime(long times, char* buffer, std::size_t size);
+};  // namespace Format
 
 #endif
@@ -0,0 +1,36 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <curses.h>
+
+#include <string_view>
+#include <vector>
+
+/*
+A grid of curses cells composed in memory and drawn differentially
+Each frame is composed from scratch with Clear() and Put(), then Flush()
+writes only the runs of cells that differ from the previous flush. The grid
+allocates only when Resize() changes its size; it also forces the next
+flush to draw every cell.
+*/
+class Frame {
+ public:
+  void Resize(int rows, int columns);
+  int Rows() const;
+  int Columns() const;
+  void Clear();
+  // Text outside the grid is clipped, ex.: Put(1, 2, "OS: Linux")
+  void Put(int row, int column, std::string_view text,
+           chtype attributes = A_NORMAL);
+  void Put(int row, int column, chtype cell);
+  void Box(int top, int bottom);  // border around rows top..bottom
+  int Flush(WINDOW* window);      // returns the cells written
+
+ private:
+  int rows_{0};
+  int columns_{0};
+  std::vector<chtype> next_ = {};
+  std::vector<chtype> drawn_ = {};  // what the window shows
+};
+
+#endif
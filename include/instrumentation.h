@@ -0,0 +1,82 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+
+// Set by CMake, see the MONITOR_INSTRUMENTATION option. At 0 the macros
+// below expand to nothing and Now() reports zeros.
+#ifndef MONITOR_INSTRUMENT
+#define MONITOR_INSTRUMENT 1
+#endif
+
+/*
+Process-wide counters of what the monitor itself costs
+Phases are timed on the thread that drives them with a monotonic clock, so
+a parallel phase counts its wall time once. A period's cost is the Delta()
+of two Now() readings.
+*/
+namespace Instrumentation {
+enum Phase { kEnumerate, kParse, kRank, kResolve, kRender, kPhases };
+char const* Name(Phase phase);
+
+struct Totals {
+  long long phase_ns[kPhases]{};
+  long files_opened{0};
+  long bytes_read{0};
+  long allocations{0};
+};
+Totals Now();
+Totals Delta(Totals const& later, Totals const& earlier);
+
+#if MONITOR_INSTRUMENT
+struct Counters {
+  std::atomic<long long> phase_ns[kPhases]{};
+  std::atomic<long> files_opened{0};
+  std::atomic<long> bytes_read{0};
+  std::atomic<long> allocations{0};
+};
+extern Counters counters;
+
+// Adds the time between construction and destruction to a phase
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(Phase phase)
+      : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer() {
+    counters.phase_ns[phase_].fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_)
+            .count(),
+        std::memory_order_relaxed);
+  }
+  PhaseTimer(PhaseTimer const&) = delete;
+  PhaseTimer& operator=(PhaseTimer const&) = delete;
+
+ private:
+  Phase phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+#endif
+}  // namespace Instrumentation
+
+#if MONITOR_INSTRUMENT
+#define MONITOR_CONCAT_(a, b) a##b
+#define MONITOR_CONCAT(a, b) MONITOR_CONCAT_(a, b)
+// Times the rest of the enclosing scope, ex.: MONITOR_PHASE(kRank);
+#define MONITOR_PHASE(phase)                                          \
+  Instrumentation::PhaseTimer MONITOR_CONCAT(phase_timer_, __LINE__)( \
+      Instrumentation::phase)
+#define MONITOR_COUNT_OPEN()                        \
+  Instrumentation::counters.files_opened.fetch_add( \
+      1, std::memory_order_relaxed)
+#define MONITOR_COUNT_READ(bytes)                 \
+  Instrumentation::counters.bytes_read.fetch_add( \
+      static_cast<long>(bytes), std::memory_order_relaxed)
+#else
+#define MONITOR_PHASE(phase) static_cast<void>(0)
+#define MONITOR_COUNT_OPEN() static_cast<void>(0)
+#define MONITOR_COUNT_READ(bytes) static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef KEYED_LINES_H
+#define KEYED_LINES_H
+
+#include <bitset>
+#include <cstddef>
+#include <string_view>
+
+/*
+Table-driven reader for "Key: value" files like /proc/meminfo and
+/proc/[pid]/status
+A caller lists the keys it needs and the field each number goes to. The
+file is scanned once and the scan stops as soon as every key was found, so
+a table of early keys never looks at the rest of the file. Values are the
+first decimal after the colon, ex.: 16337748 for "MemTotal: 16337748 kB"
+and the real uid for "Uid:	1000	1000	1000	1000".
+*/
+namespace KeyedLines {
+template <typename Record>
+struct Key {
+  std::string_view name;  // without the colon
+  long Record::*field;
+};
+
+// Splits the next line off content, false when it has no "key:"
+bool Next(std::string_view& content, std::string_view& key, long& value);
+
+// DONE: Fill the field of every key found, returns how many were
+template <typename Record, std::size_t N>
+std::size_t Parse(std::string_view content, Key<Record> const (&keys)[N],
+                  Record& record) {
+  std::bitset<N> found;
+  std::string_view key;
+  long value{0};
+  while (!found.all() && !content.empty()) {
+    if (!Next(content, key, value)) continue;
+    for (std::size_t i = 0; i < N; ++i) {
+      if (!found[i] && keys[i].name == key) {
+        record.*keys[i].field = value;
+        found.set(i);
+        break;
+      }
+    }
+  }
+  return found.count();
+}
+};  // namespace KeyedLines
+
+#endif
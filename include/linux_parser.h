@@ -1,9 +1,11 @@
 #ifndef SYSTEM_PARSER_H
 #define SYSTEM_PARSER_H
 
-#include <fstream>
+#include <cstddef>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace LinuxParser {
 // Paths
@@ -11,16 +13,45 @@ const std::string kProcDirectory{"/proc/"};
 const std::string kCmdlineFilename{"/cmdline"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
+const std::string kTaskDirectory{"/task"};
 const std::string kStatFilename{"/stat"};
 const std::string kUptimeFilename{"/uptime"};
 const std::string kMeminfoFilename{"/meminfo"};
+const std::string kLoadavgFilename{"/loadavg"};
 const std::string kVersionFilename{"/version"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
 
+// Roots every reader goes through, the paths above unless SetRoots() moved
+// them, ex.: to a synthetic tree. Set them before the first read.
+void SetRoots(std::string proc_directory, std::string password_path);
+std::string const& ProcDirectory();
+std::string const& PasswordPath();
+
 // System
+// Fields of /proc/meminfo the monitor uses, in kB
+struct MemInfo {
+  long total{0};
+  long free{0};
+  long available{0};
+  long buffers{0};
+  long cached{0};
+  long swap_total{0};
+  long swap_free{0};
+  float Utilization() const;
+};
+bool Memory(std::string_view meminfo, MemInfo& memory);
 float MemoryUtilization();
+float MemoryUtilization(std::string_view meminfo);
 long int UpTime();
+long int UpTime(std::string_view uptime);
+// Nanoseconds since boot, suspend included, from CLOCK_BOOTTIME
+long long BootTime();
+// Last pid the kernel handed out, -1 when unknown
+int LastPid(std::string_view loadavg);
+long TicksPerSecond();  // CLK_TCK, the unit of every jiffies count
+// Share of one CPU that active_ticks of CPU time make over elapsed_ns
+float CpuShare(long active_ticks, long long elapsed_ns);
 std::vector<int> Pids();
 int TotalProcesses();
 int RunningProcesses();
@@ -40,6 +71,33 @@ enum CPUStates {
   kGuest_,
   kGuestNice_
 };
+// One parsed row of cpu jiffies, indexed by CPUStates
+struct CpuTimes {
+  long states[kGuestNice_ + 1]{};
+  long Active() const;
+  long Idle() const;
+  long Busy() const;  // user + nice + system, what processes are charged
+};
+
+// The cpuN rows, one array per CPU state: states[kIdle_][n] is the idle
+// time of the nth row, so per-core math runs down contiguous columns
+struct CoreTimes {
+  std::size_t count{0};
+  std::vector<long> states[kGuestNice_ + 1];
+};
+
+// Every row of /proc/stat we care about, read in a single pass
+struct StatSnapshot {
+  CpuTimes cpu;
+  CoreTimes cores;
+  long context_switches{0};
+  long processes{0};
+  int procs_running{0};
+  int procs_blocked{0};
+};
+bool Stat(StatSnapshot& snapshot);
+bool Stat(std::string_view stat, StatSnapshot& snapshot);
+
 std::vector<std::string> CpuUtilization();
 long Jiffies();
 long ActiveJiffies();
@@ -47,10 +105,40 @@ long ActiveJiffies(int);
 long IdleJiffies();
 
 // Processes
+// Fields of /proc/[pid]/stat the monitor uses, see proc(5)
+struct PidStat {
+  char comm[64]{};  // TASK_COMM_LEN is 16, may hold spaces and parentheses
+  char state{0};
+  int ppid{0};
+  long utime{0};
+  long stime{0};
+  long cutime{0};
+  long cstime{0};
+  long long starttime{0};
+  unsigned long vsize{0};
+  long rss{0};
+  long num_threads{0};
+  long ActiveJiffies() const;
+};
+bool Stat(int pid, PidStat& stat);
+bool Stat(int pid, int tid, PidStat& stat);
+bool Stat(std::string_view content, PidStat& stat);
+
+// Fields of /proc/[pid]/status the monitor uses, sizes in kB
+struct PidStatus {
+  long uid{-1};  // real
+  long vm_size{0};
+  long vm_rss{0};
+  long threads{0};
+};
+bool Status(int pid, PidStatus& status);
+void Status(std::string_view content, PidStatus& status);
+
 std::string Command(int);
 std::string Ram(int);
 std::string Uid(int);
 std::string User(int);
+std::string UserName(int uid);
 long int UpTime(int);
 };  // namespace LinuxParser
 
@@ -3,14 +3,47 @@
 
 #include <curses.h>
 
+#include <cstddef>
+#include <vector>
+
+#include "frame.h"
+#include "instrumentation.h"
+#include "linux_parser.h"
 #include "process.h"
-#include "system.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
 
 namespace NCursesDisplay {
-void Display(System& system, int n = 10);
-void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
+int constexpr kInputTimeoutMs{50};
+int constexpr kSystemRows{9};   // system box without the heat strip
+int constexpr kStripColumn{10};  // where bars and the heat strip start
+int constexpr kBars{50};         // one per 2%
+
+// Where each process column starts, the command takes what is left
+struct Columns {
+  int pid;
+  int user;
+  int cpu;
+  int ram;
+  int time;
+  int command;
+  int end;
+};
+Columns ColumnsFor(int width);
+
+void Display(SnapshotSource& source);
+void DisplaySystem(Snapshot const& system, Frame& frame);
+void DisplayCores(std::vector<float> const& cores, Frame& frame, int& row);
+int HeatStripRows(std::size_t cores, int width);
+char HeatLevel(float utilization);
+void DisplayProcesses(std::vector<ProcessRow> const& processes, Frame& frame,
+                      int top, int n, SortKey key = SortKey::kCpu);
+bool SortKeyFor(int input, SortKey& key);
+int StatsLine(Instrumentation::Totals const& stats, char* buffer,
+              std::size_t size);
+int ProgressBar(float percent, char* buffer, std::size_t size);
+int MemoryFigures(LinuxParser::MemInfo const& memory, char* buffer,
+                  std::size_t size);
 };  // namespace NCursesDisplay
 
-#endif
\ No newline at end of file
+#endif
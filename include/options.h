@@ -0,0 +1,44 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "linux_parser.h"
+#include "process.h"
+#include "process_table.h"
+#include "snapshot.h"
+#include "system.h"
+#include "thread_table.h"
+
+enum class OutputFormat { kCsv, kJsonLines };
+
+// Command line settings, see Options::Usage for the flags
+struct Options {
+  std::size_t workers{System::kDefaultWorkers};
+  unsigned max_backoff{ProcessTable::kDefaultMaxBackoff};
+  bool threads{false};  // list threads under each process row
+  std::size_t thread_budget{ThreadTable::kDefaultBudget};
+  std::chrono::milliseconds interval{1000};
+  std::size_t top{10};  // 0 keeps every process, batch mode only
+  SortKey key{SortKey::kCpu};
+  std::string user;  // only this user's processes, empty shows all
+  bool batch{false};
+  long iterations{0};  // snapshots taken, 0 runs until killed
+  OutputFormat format{OutputFormat::kCsv};
+  std::string output;  // empty writes to stdout
+  unsigned fields{kAllFields};
+  std::string record;  // ring file every sample is appended to
+  std::size_t record_mb{64};
+  std::string serve;   // metrics on a 127.0.0.1 port or a unix socket
+  std::string replay;  // recording played back instead of sampling
+  double speed{1};     // replay speed, 0 plays back to back
+  std::string proc{LinuxParser::kProcDirectory};
+  std::string passwd{LinuxParser::kPasswordPath};
+
+  bool Parse(int argc, char* argv[], std::string& error);
+  static std::string Usage(char const* program);
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PID_DIRECTORY_H
+#define PID_DIRECTORY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+The /proc directory kept open for the life of the object
+Every Read() rewinds it and lists it with getdents64(2) into the same
+buffer. Numeric names are parsed where the kernel wrote them, anything that
+does not start with a digit is skipped on its first byte. A descriptor that
+fails is reopened once before giving up, like ProcFile.
+*/
+class PidDirectory {
+ public:
+  explicit PidDirectory(std::string path, std::size_t capacity = 64 << 10);
+  ~PidDirectory();
+  PidDirectory(PidDirectory const&) = delete;
+  PidDirectory& operator=(PidDirectory const&) = delete;
+
+  // Replaces pids, keeping its capacity. Sorted ascending on request;
+  // procfs lists in pid order already, so that is only a check there.
+  bool Read(std::vector<int>& pids, bool sorted = false);
+
+ private:
+  bool Open();
+  void Close();
+  bool Fill(std::vector<int>& pids);
+
+  std::string path_;
+  int fd_{-1};
+  std::vector<char> buffer_;
+};
+
+#endif
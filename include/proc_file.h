@@ -0,0 +1,35 @@
+#ifndef PROC_FILE_H
+#define PROC_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+A /proc file kept open for the life of the object
+Every Read() re-generates the file with pread(2) at offset 0 into the same
+buffer, so a refresh costs one syscall instead of open/read/close plus a
+stream allocation. The buffer grows until the file fits and is always NUL
+terminated. A descriptor that fails is reopened once before giving up.
+*/
+class ProcFile {
+ public:
+  explicit ProcFile(std::string path, std::size_t capacity = 4096);
+  ~ProcFile();
+  ProcFile(ProcFile const&) = delete;
+  ProcFile& operator=(ProcFile const&) = delete;
+
+  std::string_view Read();  // empty when the file cannot be read
+
+ private:
+  bool Open();
+  void Close();
+  long Fill();
+
+  std::string path_;
+  int fd_{-1};
+  std::vector<char> buffer_;
+};
+
+#endif
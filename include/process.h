@@ -1,7 +1,14 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <memory>
 #include <string>
+
+#include "linux_parser.h"
+
+// Columns the process list can be ranked by
+enum class SortKey { kCpu, kRam, kCpuTime, kAge, kPid };
+
 /*
 Basic class for Process representation
 It contains relevant attributes as shown below
@@ -11,19 +18,39 @@ class Process {
   Process(int);
   int Pid() const;
   std::string User() const;
+  int Uid() const;
   std::string Command() const;
   float CpuUtilization() const;
-  void CpuUtilization(long, long);
+  void CpuUtilization(long active_ticks, long long boot_ns);
+  void Update(LinuxParser::PidStat const&, long long boot_ns);
+  LinuxParser::PidStat const& Stat() const;
   std::string Ram() const;
   long int UpTime() const;
+  long Rss() const;
+  long CpuTime() const;
+  int Compare(Process const&, SortKey) const;
   bool operator<(Process const&) const;
   bool operator>(Process const&) const;
 
  private:
+  // Fixed once a process has exec'd, read on first use and shared by every
+  // copy of this Process. A new (pid, starttime) gets a new Process.
+  struct Attributes {
+    bool command_loaded{false};
+    bool user_loaded{false};
+    std::string command;
+    int uid{-1};
+    std::string user;
+  };
+  Attributes& Cached() const;
+  void Resolve(LinuxParser::PidStatus const& status) const;
+
   int pid_{1};
   float cpu_{0};
   long prev_active_ticks_{0};
-  long prev_system_ticks_{0};
+  long long prev_boot_ns_{0};  // when prev_active_ticks_ was read
+  LinuxParser::PidStat stat_{};
+  std::shared_ptr<Attributes> attributes_;
 };
 
 #endif
@@ -0,0 +1,143 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "linux_parser.h"
+#include "process.h"
+#include "snapshot.h"
+#include "string_pool.h"
+#include "worker_pool.h"
+
+/*
+Incremental table of live processes
+Entries are keyed by (pid, starttime): a pid that shows up with a new start
+time is a different process and starts its accounting from scratch.
+Idle processes are polled less often: every sample that shows no CPU time
+doubles the ticks until the next one, up to the maximum backoff. Running
+processes and the rows on screen, see Hot(), are sampled every tick.
+Two machine-wide counters, see Activity, keep a skipped process from going
+unnoticed: a pid the kernel handed out since the last update is sampled,
+it may be a new process, and CPU time the samples do not account for gets
+every skipped process sampled in the same update.
+
+Entries are stored as columns, one vector per field, and addressed by
+slot. Ranking reads only the column of its key plus the pids. Names,
+commands and users are interned in one StringPool, so a user or command
+shared by many processes is stored once. Slots are only stable until the
+next Update().
+
+Anything beyond the stat sample is loaded on demand, see FieldSources:
+Prepare() for what ranking and the filter need on every process, Load()
+for the columns of a shown row.
+*/
+class ProcessTable {
+ public:
+  using Slot = std::uint32_t;
+
+  // Ticks an idle process may go unsampled, 1 samples everything every tick
+  static constexpr unsigned kDefaultMaxBackoff{16};
+
+  // What the whole machine did up to this update, below 0 is unknown
+  struct Activity {
+    long busy_ticks{-1};  // LinuxParser::CpuTimes::Busy() of all CPUs
+    int last_pid{-1};     // see LinuxParser::LastPid
+  };
+
+  void Update(std::vector<int> const& pids, long long boot_ns,
+              Activity const& activity, WorkerPool& pool);
+  void Filter(std::string_view user);
+  void Prepare(SortKey key);
+  void Top(std::size_t n, SortKey key, std::vector<Slot>& top) const;
+  void Hot(std::vector<Slot> const& slots);
+  void Load(Slot slot, unsigned fields, ProcessRow& row);
+  void MaxBackoff(unsigned ticks);
+  std::size_t Size() const;
+  int Added() const;
+  int Reaped() const;
+  int Sampled() const;
+
+  // Columns of one slot
+  int Pid(Slot slot) const;
+  long long StartTime(Slot slot) const;
+  float CpuUtilization(Slot slot) const;
+  long UpTime(Slot slot) const;
+  long Rss(Slot slot) const;  // kB
+  long CpuTime(Slot slot) const;
+  // Read on first use, they cost a file read
+  std::string_view User(Slot slot);
+  int Uid(Slot slot);
+  std::string_view Command(Slot slot);
+
+ private:
+  static constexpr std::size_t kChunk{128};  // pids claimed at once
+  static constexpr StringPool::Id kUnread{~StringPool::Id{0}};
+
+  int Compare(Slot a, Slot b, SortKey key) const;
+  unsigned Loaded(Slot slot) const;
+  std::string_view Name(StringPool::Id id) const;
+  void Add(int pid);
+  void Reset(Slot slot);
+  void Reap(Slot slot);
+  long ReadDue(std::size_t first, long long boot_ns, WorkerPool& pool);
+  bool Allocated(int pid, Activity const& activity) const;
+  bool Unaccounted(Activity const& activity, long long boot_ns,
+                   long accounted) const;
+  void Apply(Slot slot, LinuxParser::PidStat const& stat, long long boot_ns);
+  void Schedule(Slot slot, bool active);
+  void Resolve(Slot slot, LinuxParser::PidStatus const& status);
+
+  // One /proc/[pid]/stat read, filled by whichever worker owns its index
+  struct Sample {
+    bool valid{false};
+    LinuxParser::PidStat stat{};
+  };
+
+  // Polling state of a slot, in generations
+  struct Backoff {
+    unsigned due{0};  // next generation that samples it
+    unsigned ticks{1};
+  };
+
+  // Fields only a sample or a resolved row reads
+  struct Cold {
+    long active_ticks{0};  // utime + stime + cutime + cstime
+    long long boot_ns{0};  // when active_ticks was read
+    long utime{0};
+    StringPool::Id comm{0};
+    StringPool::Id command{kUnread};
+    StringPool::Id user{kUnread};
+    int uid{-1};
+  };
+
+  std::vector<int> due_ = {};         // pids sampled by this update
+  std::vector<Sample> samples_ = {};  // parallel to due_
+  std::vector<int> skipped_ = {};     // known pids not due this update
+  Activity activity_ = {};            // as of the last update
+  long long boot_ns_{0};              // when the last update sampled
+
+  // Columns, parallel by slot; ranking reads the first five
+  std::vector<int> pids_ = {};
+  std::vector<float> cpu_ = {};
+  std::vector<long> rss_ = {};  // pages
+  std::vector<long> cpu_times_ = {};
+  std::vector<long long> starttimes_ = {};
+  std::vector<Cold> cold_ = {};
+  std::vector<unsigned> seen_ = {};  // generation that last saw each slot
+  std::vector<Backoff> backoff_ = {};
+
+  std::unordered_map<int, Slot> slots_ = {};  // pid -> slot
+  StringPool strings_;
+  StringPool::Id filter_{kUnread};  // the only user ranked, kUnread: all
+  unsigned generation_{0};
+  unsigned max_backoff_{kDefaultMaxBackoff};
+  int added_{0};
+  int reaped_{0};
+};
+
+#endif
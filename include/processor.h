@@ -1,13 +1,29 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include <cstddef>
+#include <vector>
+
+#include "linux_parser.h"
+
 class Processor {
  public:
-  float Utilization();
+  void Update(LinuxParser::CpuTimes const& times);
+  void Update(LinuxParser::CoreTimes const& cores);
+  float Utilization() const;
+  std::vector<float> const& Cores() const;
 
  private:
+  float utilization_{0};
   long prev_active_ticks_{0};
   long prev_idle_ticks_{0};
+
+  // Per core, indexed like the cpuN rows
+  std::vector<float> cores_;
+  std::vector<long> active_ticks_;
+  std::vector<long> idle_ticks_;
+  std::vector<long> prev_core_active_ticks_;
+  std::vector<long> prev_core_idle_ticks_;
 };
 
-#endif
\ No newline at end of file
+#endif
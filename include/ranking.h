@@ -0,0 +1,14 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include <cstddef>
+#include <vector>
+
+#include "process.h"
+
+namespace Ranking {
+void Top(std::vector<Process> const& processes, std::size_t n, SortKey key,
+         std::vector<Process>& top);  // See src/ranking.cpp
+};  // namespace Ranking
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <cstddef>
+#include <string>
+
+#include "recording.h"
+#include "snapshot.h"
+
+/*
+Appends snapshots to a memory-mapped ring file, see Recording
+Rows are encoded straight into the mapped slot, there is no staging buffer
+and no write(2) per tick; the kernel writes the dirty pages back. An
+existing recording with the same geometry is continued, anything else is
+started over.
+*/
+class Recorder {
+ public:
+  Recorder(std::string path, std::size_t max_bytes, std::size_t rows);
+  ~Recorder();
+  Recorder(Recorder const&) = delete;
+  Recorder& operator=(Recorder const&) = delete;
+
+  bool Open(std::string& error);
+  void Append(Snapshot const& snapshot);
+
+ private:
+  Recording::Record* RecordAt(std::size_t slot);
+
+  std::string path_;
+  std::size_t max_bytes_;
+  std::uint32_t rows_;
+  int fd_{-1};
+  void* map_{nullptr};
+  std::size_t map_size_{0};
+  Recording::Header* header_{nullptr};
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+On-disk layout of a history recording, written by Recorder and read back by
+Replayer. The file is a header followed by a ring of fixed-size records,
+each holding one tick and up to rows_per_record process rows.
+
+Counters are stored as deltas to the previous record. The header keeps the
+absolute values just before the oldest record still in the ring; when the
+ring wraps, the deltas of the record being overwritten are folded into
+that base first, so the oldest record always decodes.
+*/
+namespace Recording {
+constexpr char kMagic[8] = {'C', 'P', 'P', 'M', 'O', 'N', 'R', '1'};
+constexpr std::uint32_t kVersion{1};
+constexpr std::uint32_t kMaxRows{64};
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint32_t rows_per_record;
+  std::uint32_t capacity;  // records in the ring
+  std::uint64_t written;   // records ever appended, slot is written % capacity
+  // Absolute values before the oldest record in the ring
+  std::int64_t base_time_ms;
+  std::int64_t base_uptime;
+  std::int64_t base_total_processes;
+  // Absolute values of the newest record, the next delta starts from here
+  std::int64_t last_time_ms;
+  std::int64_t last_uptime;
+  std::int64_t last_total_processes;
+  char operating_system[64];
+  char kernel[64];
+};
+
+struct Row {
+  std::int32_t pid;
+  float cpu;
+  std::int32_t ram_mb;
+  std::int32_t time;  // TIME+ seconds
+  char user[16];
+  char command[48];
+};
+
+struct Record {
+  std::uint32_t time_delta_ms;
+  std::int32_t uptime_delta;
+  std::int32_t total_processes_delta;
+  std::int32_t running_processes;
+  float cpu;
+  float memory;
+  std::uint16_t key;
+  std::uint16_t rows;
+  // rows_per_record Row entries follow
+};
+
+constexpr std::size_t RecordSize(std::uint32_t rows) {
+  return sizeof(Record) + rows * sizeof(Row);
+}
+};  // namespace Recording
+
+#endif
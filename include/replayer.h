@@ -0,0 +1,59 @@
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "process.h"
+#include "recording.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
+
+/*
+Plays a recording back as snapshots, oldest record first
+Records are spaced by their recorded time divided by speed; a speed of 0
+publishes them back to back. Re-sorting only reorders the rows that were
+recorded, which were ranked by the key in use at recording time.
+*/
+class Replayer : public SnapshotSource {
+ public:
+  Replayer(std::string path, double speed);
+  ~Replayer() override;
+  Replayer(Replayer const&) = delete;
+  Replayer& operator=(Replayer const&) = delete;
+
+  bool Load(std::string& error);
+  void Start() override;
+  void Stop() override;
+  void SortBy(SortKey key) override;
+  SortKey Key() const override;
+  std::size_t Rows() const override;
+
+ private:
+  void Run();
+  bool Wait(std::chrono::steady_clock::time_point due);
+  Recording::Record const* RecordAt(std::size_t slot) const;
+  void Sort(Snapshot& snapshot) const;
+
+  std::string path_;
+  double speed_;
+  void* map_{nullptr};
+  std::size_t map_size_{0};
+  Recording::Header const* header_{nullptr};
+  std::atomic<SortKey> key_{SortKey::kCpu};
+  std::shared_ptr<Snapshot const> last_;  // replay thread only
+  unsigned long epoch_{0};                // replay thread only
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool resort_{false};
+  bool stop_{false};
+};
+
+#endif
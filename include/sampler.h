@@ -0,0 +1,64 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "instrumentation.h"
+#include "process.h"
+#include "recorder.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
+#include "system.h"
+
+/*
+Background thread that samples System on a fixed-rate schedule
+Each pass is published as a new immutable Snapshot. Deadlines advance by
+whole periods from the start time, so time spent collecting does not
+stretch the refresh period, and a pass that overruns skips the slots it
+missed instead of bursting to catch up.
+*/
+class Sampler : public SnapshotSource {
+ public:
+  Sampler(System& system, std::chrono::milliseconds period, std::size_t rows,
+          SortKey key = SortKey::kCpu, unsigned fields = kAllFields);
+  ~Sampler() override;
+  Sampler(Sampler const&) = delete;
+  Sampler& operator=(Sampler const&) = delete;
+
+  void Start() override;
+  void Stop() override;
+  void SortBy(SortKey key) override;
+  SortKey Key() const override;
+  std::size_t Rows() const override;
+  void RecordTo(Recorder* recorder);
+
+ private:
+  void Run();
+  void Sample(bool resample);
+  void AddThreads(ProcessRow const& process, Snapshot& snapshot);
+
+  System& system_;
+  std::chrono::milliseconds period_;
+  std::size_t rows_;
+  std::atomic<SortKey> key_;
+  unsigned fields_;
+  Recorder* recorder_{nullptr};
+  std::vector<Process> threads_ = {};     // sampler thread only
+  std::shared_ptr<Snapshot const> last_;  // sampler thread only
+  Instrumentation::Totals totals_;        // sampler thread only
+  unsigned long epoch_{0};
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool resort_{false};
+  bool stop_{false};
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+/*
+Allocation-free cursor over /proc text, shared by every reader
+Lines and delimited fields are found with memchr, which glibc scans a
+vector register at a time, and numbers are parsed in place with
+std::from_chars. Every view points into the caller's buffer, nothing is
+copied. The members are defined here so the readers' loops inline them.
+*/
+class Scanner {
+ public:
+  explicit Scanner(std::string_view text) : text_(text) {}
+
+  bool Empty() const { return text_.empty(); }
+  std::string_view Rest() const { return text_; }
+
+  // Skips spaces and tabs, not newlines
+  void SkipBlanks() {
+    std::size_t i{0};
+    while (i < text_.size() && (text_[i] == ' ' || text_[i] == '\t')) ++i;
+    text_.remove_prefix(i);
+  }
+
+  // Up to the next '\n', which is consumed, or the end
+  std::string_view Line() { return Until('\n'); }
+
+  // Up to the next delimiter, which is consumed, or the end
+  std::string_view Until(char delimiter) {
+    auto found = static_cast<char const*>(
+        std::memchr(text_.data(), delimiter, text_.size()));
+    std::size_t length =
+        found == nullptr ? text_.size() : found - text_.data();
+    std::string_view field = text_.substr(0, length);
+    text_.remove_prefix(found == nullptr ? length : length + 1);
+    return field;
+  }
+
+  // The next run of characters after blanks, ex.: "cpu0" of "cpu0 4058841"
+  std::string_view Word() {
+    SkipBlanks();
+    std::size_t length{0};
+    while (length < text_.size() && text_[length] != ' ' &&
+           text_[length] != '\t' && text_[length] != '\n') {
+      ++length;
+    }
+    std::string_view word = text_.substr(0, length);
+    text_.remove_prefix(length);
+    return word;
+  }
+
+  // The next decimal after blanks, false and value untouched without one
+  // Stops at the first character that is not part of it, ex.: the '.' of
+  // "769125.59" for an integer.
+  template <typename T>
+  bool Number(T& value) {
+    SkipBlanks();
+    char const* end = text_.data() + text_.size();
+    auto [next, error] = std::from_chars(text_.data(), end, value);
+    if (error != std::errc{}) return false;
+    text_.remove_prefix(next - text_.data());
+    return true;
+  }
+
+ private:
+  std::string_view text_;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+#include "linux_parser.h"
+#include "process.h"
+
+// Per-process columns, a row only pays for the ones that are selected
+// kCoresField and kStatsField add the per-core utilization and the
+// monitor's own costs to the system columns, kThreadsField lists the
+// threads under each process row. They are not in kAllFields.
+enum Field : unsigned {
+  kPidField = 1 << 0,
+  kUserField = 1 << 1,
+  kCpuField = 1 << 2,
+  kRamField = 1 << 3,
+  kTimeField = 1 << 4,
+  kCommandField = 1 << 5,
+  kAllFields = (1 << 6) - 1,
+  kCoresField = 1 << 6,
+  kStatsField = 1 << 7,
+  kThreadsField = 1 << 8
+};
+
+// One process row as drawn, resolved on the sampler thread
+struct ProcessRow {
+  int pid{0};   // the tid on a thread row
+  int tgid{0};  // the process of a thread row, 0 on a process row
+  std::string user;
+  float cpu{0};
+  std::string ram;
+  long rss{0};  // kB, the number behind ram
+  long uptime{0};
+  std::string command;
+};
+
+/*
+Everything one frame shows, taken in a single sampling pass
+Snapshots are immutable once published, so the render thread reads them
+without locking.
+*/
+struct Snapshot {
+  unsigned long epoch{0};
+  long long time_ms{0};  // wall clock of the pass, ms since the Unix epoch
+  std::string operating_system;
+  std::string kernel;
+  float cpu{0};
+  std::vector<float> cores;  // utilization per cpuN row
+  float memory{0};
+  LinuxParser::MemInfo memory_info;  // all zeros in a replay
+  int total_processes{0};
+  int running_processes{0};
+  long uptime{0};
+  SortKey key{SortKey::kCpu};
+  std::vector<ProcessRow> processes;
+  // What the monitor spent since the previous sample, rendering included
+  Instrumentation::Totals stats;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SNAPSHOT_SOURCE_H
+#define SNAPSHOT_SOURCE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "process.h"
+#include "snapshot.h"
+
+/*
+Anything that publishes snapshots for the display and batch output
+Publication swaps a shared_ptr atomically: readers of Latest() never wait
+for a producer, and Next() is there for consumers that want every epoch.
+*/
+class SnapshotSource {
+ public:
+  virtual ~SnapshotSource() = default;
+  virtual void Start() = 0;
+  virtual void Stop() = 0;
+  virtual void SortBy(SortKey key) = 0;
+  virtual SortKey Key() const = 0;
+  virtual std::size_t Rows() const = 0;
+
+  std::shared_ptr<Snapshot const> Latest() const;
+  std::shared_ptr<Snapshot const> Next(unsigned long epoch);
+  // Publish() holds a new snapshot back until Next() took the previous one
+  void Lossless(bool lossless);
+
+ protected:
+  void Publish(std::shared_ptr<Snapshot const> snapshot);
+  void Open();
+  void Close();
+
+ private:
+  std::shared_ptr<Snapshot const> latest_;  // std::atomic_load/store only
+  std::mutex mutex_;
+  std::condition_variable published_;
+  std::condition_variable taken_;
+  unsigned long published_epoch_{0};
+  unsigned long taken_epoch_{0};
+  bool lossless_{false};
+  bool closed_{false};
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Interned strings with reference counts
+Equal strings share one id and one copy, ex.: every process of user "www"
+points at the same "www". An id stays valid until Release() drops its last
+reference, then its slot is reused. Id 0 is the empty string and is never
+released.
+*/
+class StringPool {
+ public:
+  using Id = std::uint32_t;
+
+  StringPool();
+  StringPool(StringPool const&) = delete;
+  StringPool& operator=(StringPool const&) = delete;
+
+  Id Intern(std::string_view text);  // adds a reference
+  void Release(Id id);
+  std::string_view View(Id id) const;
+  std::size_t Size() const;  // distinct strings held
+
+ private:
+  struct Entry {
+    std::string text;
+    std::uint32_t references{0};
+  };
+
+  std::deque<Entry> entries_;  // a deque never moves the strings ids_ views
+  std::vector<Id> free_ = {};
+  std::unordered_map<std::string_view, Id> ids_ = {};
+};
+
+#endif
@@ -1,28 +1,67 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+#include "linux_parser.h"
+#include "pid_directory.h"
+#include "proc_file.h"
 #include "process.h"
+#include "process_table.h"
 #include "processor.h"
+#include "thread_table.h"
+#include "worker_pool.h"
 
 class System {
  public:
-  System();
+  // Keep the monitor from being the busiest process on the box it watches
+  static constexpr std::size_t kDefaultWorkers{2};
+
+  explicit System(std::size_t workers = kDefaultWorkers);
+  void Refresh();
   Processor& Cpu();
-  std::vector<Process>& Processes();
+  // Slots of the n best ranked processes, valid until the next Processes()
+  std::vector<ProcessTable::Slot> const& Processes(
+      std::size_t n = 10, SortKey key = SortKey::kCpu);
+  std::vector<ProcessTable::Slot> const& Rank(std::size_t n, SortKey key);
+  ProcessTable& Table();
   float MemoryUtilization() const;
-  long UpTime();
-  int TotalProcesses();
-  int RunningProcesses();
+  LinuxParser::MemInfo const& Memory() const;
+  long UpTime() const;
+  int TotalProcesses() const;
+  int RunningProcesses() const;
+  int BlockedProcesses() const;
+  long ContextSwitches() const;
+  int ProcessesAdded() const;
+  int ProcessesReaped() const;
+  int ProcessesSampled() const;
+  void MaxBackoff(unsigned ticks);
+  void Filter(std::string const& user);
+  void UpdateThreads(std::vector<ProcessTable::Slot> const& slots);
+  std::vector<Process> const& Threads(int pid) const;
+  void ThreadBudget(std::size_t reads);
   std::string Kernel() const;
   std::string OperatingSystem() const;
 
   // DONE: Define any necessary private members
  private:
   Processor cpu_ = {};
-  std::vector<Process> processes_ = {};
+  ProcFile stat_file_;
+  ProcFile meminfo_file_;
+  ProcFile uptime_file_;
+  ProcFile loadavg_file_;
+  PidDirectory pid_directory_;
+  std::vector<int> pids_ = {};  // keeps its capacity across ticks
+  LinuxParser::StatSnapshot stat_ = {};
+  LinuxParser::MemInfo memory_ = {};
+  long uptime_{0};
+  int last_pid_{-1};
+  WorkerPool pool_;
+  ProcessTable table_ = {};
+  ThreadTable threads_ = {};
+  std::vector<ProcessTable::Slot> top_ = {};
   std::string kernel_;
   std::string operating_system_;
 };
@@ -0,0 +1,53 @@
+#ifndef THREAD_TABLE_H
+#define THREAD_TABLE_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "pid_directory.h"
+#include "process.h"
+#include "process_table.h"
+
+/*
+Threads of a few processes, read from /proc/[pid]/task/[tid]/stat
+Each thread is a Process keyed by its tid, so its CPU share comes from the
+same delta as a process's. The task directories are listed every update,
+but at most budget thread stats are read per update: a process with more
+threads than its share is read in slices, continuing where the previous
+update stopped. A thread read less often still gets the right share,
+measured over the longer gap.
+*/
+class ThreadTable {
+ public:
+  static constexpr std::size_t kDefaultBudget{4096};  // stat reads per update
+
+  void Update(ProcessTable const& table,
+              std::vector<ProcessTable::Slot> const& slots, long long boot_ns);
+  void Budget(std::size_t reads);
+  // Empty for a process the last update did not cover
+  std::vector<Process> const& Threads(int pid) const;
+
+ private:
+  struct Group {
+    long long starttime{0};  // of the process, a new one starts over
+    std::unique_ptr<PidDirectory> tasks;
+    std::vector<int> tids = {};
+    std::vector<Process> threads = {};
+    std::vector<unsigned> seen = {};
+    std::unordered_map<int, std::size_t> slots = {};  // tid -> slot
+    std::size_t cursor{0};  // next slot to read
+    unsigned followed{0};   // generation that last asked for it
+  };
+
+  void List(Group& group);
+  std::size_t Read(int pid, Group& group, std::size_t reads,
+                   long long boot_ns);
+
+  std::unordered_map<int, Group> groups_ = {};  // pid -> threads
+  std::size_t budget_{kDefaultBudget};
+  unsigned generation_{0};
+};
+
+#endif
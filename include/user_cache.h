@@ -0,0 +1,36 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+uid -> user name map parsed once from /etc/passwd
+The file is stat'ed at most once per check interval and only re-parsed when
+its mtime moved. Lookups are safe from any thread.
+*/
+class UserCache {
+ public:
+  explicit UserCache(std::string path,
+                     std::chrono::milliseconds check_interval =
+                         std::chrono::seconds(1));
+  std::string Name(int uid);
+
+ private:
+  void Reload();
+  bool Parse();
+
+  std::string path_;
+  std::chrono::steady_clock::duration check_interval_;
+  std::atomic<std::chrono::steady_clock::rep> next_check_{0};
+  std::shared_mutex mutex_;
+  timespec mtime_{};
+  std::vector<std::pair<int, std::string>> names_ = {};  // sorted by uid
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Fixed pool of threads that shard an index range between them
+The calling thread takes part as worker 0, so a pool of size 1 runs
+everything inline and spawns no threads. Workers claim fixed-size chunks
+from a shared counter, so a worker stuck on a slow file does not hold up the
+chunks behind it.
+*/
+class WorkerPool {
+ public:
+  // job(worker, begin, end) is called for consecutive chunks of [0, count)
+  using Job = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+  explicit WorkerPool(std::size_t size = 2);
+  ~WorkerPool();
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  std::size_t Size() const;
+  void Run(std::size_t count, std::size_t chunk, Job const& job);
+
+ private:
+  void Work(std::size_t worker);
+  void Drain(std::size_t worker);
+
+  std::vector<std::thread> threads_ = {};
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  Job const* job_{nullptr};
+  std::size_t count_{0};
+  std::size_t chunk_{1};
+  std::atomic<std::size_t> next_{0};
+  std::size_t busy_{0};
+  unsigned long generation_{0};
+  bool stop_{false};
+};
+
+#endif
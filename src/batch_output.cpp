@@ -0,0 +1,308 @@
+#include "batch_output.h"
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "instrumentation.h"
+#include "options.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
+
+namespace {
+template <typename T>
+void Append(std::string& out, T value) {
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+// Fractions are written as percentages with two decimals
+void AppendPercent(std::string& out, float fraction) {
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), fraction * 100,
+                              std::chars_format::fixed, 2);
+  out.append(buffer, result.ptr);
+}
+
+// ex.: 12.50;3.00;100.00
+void AppendCores(std::string& out, std::vector<float> const& cores,
+                 char separator) {
+  for (std::size_t i = 0; i < cores.size(); ++i) {
+    if (i > 0) out += separator;
+    AppendPercent(out, cores[i]);
+  }
+}
+
+// ex.: 12,10400,80,310,0,1003,256000,640
+void AppendStats(std::string& out, Instrumentation::Totals const& stats) {
+  for (long long phase_ns : stats.phase_ns) {
+    Append(out, phase_ns / 1000);
+    out += ',';
+  }
+  Append(out, stats.files_opened);
+  out += ',';
+  Append(out, stats.bytes_read);
+  out += ',';
+  Append(out, stats.allocations);
+}
+
+// RFC 4180: quote when needed, double the quotes inside
+void AppendCsv(std::string& out, std::string_view text) {
+  if (text.find_first_of(",\"\n\r") == std::string_view::npos) {
+    out += text;
+    return;
+  }
+  out += '"';
+  for (char c : text) {
+    if (c == '"') out += '"';
+    out += c;
+  }
+  out += '"';
+}
+
+void AppendJson(std::string& out, std::string_view text) {
+  out += '"';
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escape[8];
+          std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+          out += escape;
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+}  // namespace
+
+// DONE: Column names, system columns first, then the selected fields
+void BatchOutput::CsvHeader(unsigned fields, std::string& out) {
+  out += "time_ms,system_cpu,memory,total_processes,running_processes,uptime";
+  if (fields & kCoresField) out += ",cores";
+  if (fields & kStatsField) {
+    for (int phase = 0; phase < Instrumentation::kPhases; ++phase) {
+      out += ',';
+      out += Instrumentation::Name(Instrumentation::Phase(phase));
+      out += "_us";
+    }
+    out += ",files_opened,bytes_read,allocations";
+  }
+  if (fields & kPidField) out += ",pid";
+  if (fields & kUserField) out += ",user";
+  if (fields & kCpuField) out += ",cpu";
+  if (fields & kRamField) out += ",ram_mb";
+  if (fields & kTimeField) out += ",time";
+  if (fields & kCommandField) out += ",command";
+  if (fields & kThreadsField) out += ",tgid";
+  out += '\n';
+}
+
+// DONE: One line per process row, the system columns repeat on each
+void BatchOutput::Csv(Snapshot const& snapshot, unsigned fields,
+                      std::string& out) {
+  std::size_t prefix_begin = out.size();
+  Append(out, snapshot.time_ms);
+  out += ',';
+  AppendPercent(out, snapshot.cpu);
+  out += ',';
+  AppendPercent(out, snapshot.memory);
+  out += ',';
+  Append(out, snapshot.total_processes);
+  out += ',';
+  Append(out, snapshot.running_processes);
+  out += ',';
+  Append(out, snapshot.uptime);
+  if (fields & kCoresField) {
+    out += ',';
+    AppendCores(out, snapshot.cores, ';');
+  }
+  if (fields & kStatsField) {
+    out += ',';
+    AppendStats(out, snapshot.stats);
+  }
+  std::size_t prefix_size = out.size() - prefix_begin;
+  for (std::size_t i = 0; i < snapshot.processes.size(); ++i) {
+    ProcessRow const& row = snapshot.processes[i];
+    if (i > 0) out.append(out, prefix_begin, prefix_size);
+    if (fields & kPidField) {
+      out += ',';
+      Append(out, row.pid);
+    }
+    if (fields & kUserField) {
+      out += ',';
+      AppendCsv(out, row.user);
+    }
+    if (fields & kCpuField) {
+      out += ',';
+      AppendPercent(out, row.cpu);
+    }
+    if (fields & kRamField) {
+      out += ',';
+      out += row.ram;
+    }
+    if (fields & kTimeField) {
+      out += ',';
+      Append(out, row.uptime);
+    }
+    if (fields & kCommandField) {
+      out += ',';
+      AppendCsv(out, row.command);
+    }
+    if (fields & kThreadsField) {
+      out += ',';
+      Append(out, row.tgid);
+    }
+    out += '\n';
+  }
+  if (snapshot.processes.empty()) {
+    // Empty process columns, every line has as many as the header
+    for (unsigned field : {kPidField, kUserField, kCpuField, kRamField,
+                           kTimeField, kCommandField, kThreadsField}) {
+      if (fields & field) out += ',';
+    }
+    out += '\n';
+  }
+}
+
+// DONE: One JSON object per snapshot, processes nested in an array
+void BatchOutput::JsonLine(Snapshot const& snapshot, unsigned fields,
+                           std::string& out) {
+  out += "{\"time_ms\":";
+  Append(out, snapshot.time_ms);
+  out += ",\"system_cpu\":";
+  AppendPercent(out, snapshot.cpu);
+  out += ",\"memory\":";
+  AppendPercent(out, snapshot.memory);
+  out += ",\"total_processes\":";
+  Append(out, snapshot.total_processes);
+  out += ",\"running_processes\":";
+  Append(out, snapshot.running_processes);
+  out += ",\"uptime\":";
+  Append(out, snapshot.uptime);
+  if (fields & kCoresField) {
+    out += ",\"cores\":[";
+    AppendCores(out, snapshot.cores, ',');
+    out += ']';
+  }
+  if (fields & kStatsField) {
+    out += ",\"stats\":{";
+    for (int phase = 0; phase < Instrumentation::kPhases; ++phase) {
+      out += '"';
+      out += Instrumentation::Name(Instrumentation::Phase(phase));
+      out += "_us\":";
+      Append(out, snapshot.stats.phase_ns[phase] / 1000);
+      out += ',';
+    }
+    out += "\"files_opened\":";
+    Append(out, snapshot.stats.files_opened);
+    out += ",\"bytes_read\":";
+    Append(out, snapshot.stats.bytes_read);
+    out += ",\"allocations\":";
+    Append(out, snapshot.stats.allocations);
+    out += '}';
+  }
+  out += ",\"processes\":[";
+  for (std::size_t i = 0; i < snapshot.processes.size(); ++i) {
+    ProcessRow const& row = snapshot.processes[i];
+    out += i == 0 ? "{" : ",{";
+    char const* separator = "";
+    auto key = [&](char const* name) {
+      out += separator;
+      out += '"';
+      out += name;
+      out += "\":";
+      separator = ",";
+    };
+    if (fields & kPidField) {
+      key("pid");
+      Append(out, row.pid);
+    }
+    if (fields & kUserField) {
+      key("user");
+      AppendJson(out, row.user);
+    }
+    if (fields & kCpuField) {
+      key("cpu");
+      AppendPercent(out, row.cpu);
+    }
+    if (fields & kRamField) {
+      key("ram_mb");
+      out += row.ram.empty() ? "0" : row.ram;
+    }
+    if (fields & kTimeField) {
+      key("time");
+      Append(out, row.uptime);
+    }
+    if (fields & kCommandField) {
+      key("command");
+      AppendJson(out, row.command);
+    }
+    if (fields & kThreadsField) {
+      key("tgid");
+      Append(out, row.tgid);
+    }
+    out += '}';
+  }
+  out += "]}\n";
+}
+
+// DONE: Stream snapshots until the iteration count is reached
+// Each snapshot is formatted into one reused buffer and written with a
+// single fwrite, then flushed so a reader following the file sees whole
+// snapshots only.
+int BatchOutput::Run(SnapshotSource& source, Options const& options) {
+  std::FILE* file = options.output.empty()
+                        ? stdout
+                        : std::fopen(options.output.c_str(), "w");
+  if (file == nullptr) {
+    std::perror(options.output.c_str());
+    return 1;
+  }
+  static char file_buffer[1 << 16];
+  std::setvbuf(file, file_buffer, _IOFBF, sizeof(file_buffer));
+
+  std::string out;
+  if (options.format == OutputFormat::kCsv) {
+    CsvHeader(options.fields, out);
+  }
+  source.Start();
+  unsigned long epoch{0};
+  for (long taken = 0; options.iterations == 0 || taken < options.iterations;
+       ++taken) {
+    auto snapshot = source.Next(epoch);
+    if (snapshot == nullptr) break;
+    epoch = snapshot->epoch;
+    MONITOR_PHASE(kRender);
+    if (options.format == OutputFormat::kCsv) {
+      Csv(*snapshot, options.fields, out);
+    } else {
+      JsonLine(*snapshot, options.fields, out);
+    }
+    std::fwrite(out.data(), 1, out.size(), file);
+    std::fflush(file);
+    out.clear();
+  }
+  source.Stop();
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return 0;
+}
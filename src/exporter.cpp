@@ -0,0 +1,446 @@
+#include "exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
+
+namespace {
+constexpr char kMetricsType[] = "text/plain; version=0.0.4; charset=utf-8";
+
+template <typename T>
+void Append(std::string& out, T value) {
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+// ex.: # HELP monitor_uptime_seconds Time since boot.
+void Family(std::string& out, char const* name, char const* type,
+            char const* help) {
+  out += "# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += ' ';
+  out += type;
+  out += '\n';
+}
+
+// Label values escape backslashes, quotes and newlines
+void AppendLabel(std::string& out, char const* name, std::string_view value) {
+  out += out.back() == '{' ? "" : ",";
+  out += name;
+  out += "=\"";
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+void AppendLabel(std::string& out, char const* name, int value) {
+  out += out.back() == '{' ? "" : ",";
+  out += name;
+  out += "=\"";
+  Append(out, value);
+  out += '"';
+}
+
+// The executable of a command line, the arguments would make every
+// series unique, ex.: /usr/bin/python3 -m http.server -> /usr/bin/python3
+std::string_view Executable(std::string_view command) {
+  return command.substr(0, command.find(' '));
+}
+
+// A complete HTTP/1.1 response, the connection closes after it
+std::string Response(char const* status, char const* type,
+                     std::string_view body) {
+  std::string response;
+  response.reserve(body.size() + 128);
+  response += "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: ";
+  response += type;
+  response += "\r\nContent-Length: ";
+  Append(response, body.size());
+  response += "\r\nConnection: close\r\n\r\n";
+  response += body;
+  return response;
+}
+
+std::shared_ptr<std::string const> Error(char const* status) {
+  std::string body{status};
+  body += '\n';
+  return std::make_shared<std::string const>(
+      Response(status, "text/plain; charset=utf-8", body));
+}
+}  // namespace
+
+Exporter::Exporter(std::string address) : address_(std::move(address)) {}
+
+Exporter::~Exporter() { Close(); }
+
+// DONE: Listen on the address, false with a message if that fails
+// All digits is a port on 127.0.0.1, anything else a unix socket path. A
+// socket file nobody listens on any more is replaced.
+bool Exporter::Open(std::string& error) {
+  bool port = !address_.empty() &&
+              std::all_of(address_.begin(), address_.end(),
+                          [](unsigned char c) { return std::isdigit(c); });
+  if (port) {
+    long number{0};
+    std::from_chars(address_.data(), address_.data() + address_.size(),
+                    number);
+    if (number < 1 || number > 65535) {
+      error = address_ + ": not a port";
+      return false;
+    }
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      error = address_ + ": " + std::strerror(errno);
+      return false;
+    }
+    int reuse{1};
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(static_cast<std::uint16_t>(number));
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&local),
+             sizeof(local)) != 0) {
+      error = "127.0.0.1:" + address_ + ": " + std::strerror(errno);
+      Close();
+      return false;
+    }
+  } else {
+    sockaddr_un local{};
+    local.sun_family = AF_UNIX;
+    if (address_.size() >= sizeof(local.sun_path)) {
+      error = address_ + ": socket path too long";
+      return false;
+    }
+    address_.copy(local.sun_path, address_.size());
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      error = address_ + ": " + std::strerror(errno);
+      return false;
+    }
+    struct stat file;
+    if (lstat(address_.c_str(), &file) == 0) {
+      int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      bool live = S_ISSOCK(file.st_mode) && probe >= 0 &&
+                  connect(probe, reinterpret_cast<sockaddr*>(&local),
+                          sizeof(local)) == 0;
+      if (probe >= 0) close(probe);
+      if (!S_ISSOCK(file.st_mode) || live) {
+        error = address_ + (live ? ": in use" : ": exists, not a socket");
+        Close();
+        return false;
+      }
+      unlink(address_.c_str());
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&local),
+             sizeof(local)) != 0) {
+      error = address_ + ": " + std::strerror(errno);
+      Close();
+      return false;
+    }
+    socket_path_ = address_;
+  }
+  wake_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (listen(listen_fd_, SOMAXCONN) != 0 || wake_fd_ < 0) {
+    error = address_ + ": " + std::strerror(errno);
+    Close();
+    return false;
+  }
+  return true;
+}
+
+// DONE: Render every snapshot the source publishes for the server thread
+// Scrapes before the first snapshot get a 503.
+int Exporter::Serve(SnapshotSource& source, long iterations) {
+  thread_ = std::thread(&Exporter::Run, this);
+  std::string body;
+  source.Start();
+  unsigned long epoch{0};
+  for (long taken = 0; iterations == 0 || taken < iterations; ++taken) {
+    auto snapshot = source.Next(epoch);
+    if (snapshot == nullptr) break;
+    epoch = snapshot->epoch;
+    MONITOR_PHASE(kRender);
+    Publish(*snapshot, body);
+  }
+  source.Stop();
+  Close();
+  return 0;
+}
+
+// Swap in the response for a new snapshot, body keeps its capacity
+void Exporter::Publish(Snapshot const& snapshot, std::string& body) {
+  body.clear();
+  Render(snapshot, body);
+  std::atomic_store(&response_, std::make_shared<std::string const>(Response(
+                                    "200 OK", kMetricsType, body)));
+}
+
+// DONE: Prometheus text exposition of a snapshot
+// System figures first, then one series per process row, labeled with its
+// pid, user and executable, and one per thread row under the pid.
+void Exporter::Render(Snapshot const& snapshot, std::string& out) {
+  auto sample = [&](char const* name, auto value) {
+    out += name;
+    out += ' ';
+    Append(out, value);
+    out += '\n';
+  };
+  Family(out, "monitor_snapshot_timestamp_seconds", "gauge",
+         "Wall clock time the snapshot was sampled at.");
+  sample("monitor_snapshot_timestamp_seconds", snapshot.time_ms / 1000.0);
+  Family(out, "monitor_cpu_utilization", "gauge",
+         "Fraction of time all CPUs were busy over the last tick.");
+  sample("monitor_cpu_utilization", snapshot.cpu);
+  if (!snapshot.cores.empty()) {
+    Family(out, "monitor_core_utilization", "gauge",
+           "Fraction of time each CPU was busy over the last tick.");
+    for (std::size_t core = 0; core < snapshot.cores.size(); ++core) {
+      out += "monitor_core_utilization{core=\"";
+      Append(out, core);
+      out += "\"} ";
+      Append(out, snapshot.cores[core]);
+      out += '\n';
+    }
+  }
+  Family(out, "monitor_memory_utilization", "gauge",
+         "Fraction of memory in use.");
+  sample("monitor_memory_utilization", snapshot.memory);
+  LinuxParser::MemInfo const& memory = snapshot.memory_info;
+  if (memory.total != 0) {
+    Family(out, "monitor_memory_bytes", "gauge", "Figures of /proc/meminfo.");
+    std::pair<char const*, long> const figures[] = {
+        {"total", memory.total},         {"free", memory.free},
+        {"available", memory.available}, {"buffers", memory.buffers},
+        {"cached", memory.cached},       {"swap_total", memory.swap_total},
+        {"swap_free", memory.swap_free}};
+    for (auto const& [kind, kb] : figures) {
+      out += "monitor_memory_bytes{kind=\"";
+      out += kind;
+      out += "\"} ";
+      Append(out, kb * 1024LL);
+      out += '\n';
+    }
+  }
+  Family(out, "monitor_forks_total", "counter", "Processes created since boot.");
+  sample("monitor_forks_total", snapshot.total_processes);
+  Family(out, "monitor_processes_running", "gauge",
+         "Processes running or ready to run.");
+  sample("monitor_processes_running", snapshot.running_processes);
+  Family(out, "monitor_uptime_seconds", "gauge", "Time since boot.");
+  sample("monitor_uptime_seconds", snapshot.uptime);
+
+  // One family at a time, the process rows are walked once per family
+  auto processes = [&](char const* name, auto value) {
+    for (ProcessRow const& row : snapshot.processes) {
+      if (row.tgid != 0) continue;
+      out += name;
+      out += '{';
+      AppendLabel(out, "pid", row.pid);
+      AppendLabel(out, "user", row.user);
+      AppendLabel(out, "command", Executable(row.command));
+      out += "} ";
+      Append(out, value(row));
+      out += '\n';
+    }
+  };
+  Family(out, "monitor_process_cpu_utilization", "gauge",
+         "Fraction of a CPU the process used over the last tick.");
+  processes("monitor_process_cpu_utilization",
+            [](ProcessRow const& row) { return row.cpu; });
+  Family(out, "monitor_process_resident_memory_bytes", "gauge",
+         "Resident set size of the process.");
+  processes("monitor_process_resident_memory_bytes",
+            [](ProcessRow const& row) { return row.rss * 1024LL; });
+  Family(out, "monitor_process_user_cpu_seconds_total", "counter",
+         "CPU time the process spent in user mode.");
+  processes("monitor_process_user_cpu_seconds_total",
+            [](ProcessRow const& row) { return row.uptime; });
+
+  bool threads = std::any_of(snapshot.processes.begin(),
+                             snapshot.processes.end(),
+                             [](ProcessRow const& row) { return row.tgid; });
+  if (!threads) return;
+  Family(out, "monitor_thread_cpu_utilization", "gauge",
+         "Fraction of a CPU the thread used over the last tick.");
+  for (ProcessRow const& row : snapshot.processes) {
+    if (row.tgid == 0) continue;
+    out += "monitor_thread_cpu_utilization{";
+    AppendLabel(out, "pid", row.tgid);
+    AppendLabel(out, "tid", row.pid);
+    AppendLabel(out, "command", row.command);
+    out += "} ";
+    Append(out, row.cpu);
+    out += '\n';
+  }
+}
+
+// The server thread: one poll loop over the listening socket and every
+// open connection, none of them can block another
+void Exporter::Run() {
+  std::vector<pollfd> fds;
+  for (;;) {
+    fds.clear();
+    fds.push_back({wake_fd_, POLLIN, 0});
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (Connection const& connection : connections_) {
+      fds.push_back({connection.fd,
+                     static_cast<short>(connection.response ? POLLOUT : POLLIN),
+                     0});
+    }
+    int timeout_ms = connections_.empty() ? -1 : 1000;
+    if (poll(fds.data(), fds.size(), timeout_ms) < 0 && errno != EINTR) break;
+    if (fds[0].revents != 0) break;
+
+    auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < connections_.size(); ++i) {
+      Connection& connection = connections_[i];
+      short events = fds[i + 2].revents;
+      bool open{true};
+      if (events & POLLIN) {
+        open = Receive(connection);
+      } else if (events & POLLOUT) {
+        open = Send(connection);
+      } else if (events != 0 || now - connection.opened > kRequestTimeout) {
+        open = false;
+      }
+      if (!open) {
+        close(connection.fd);
+        connection.fd = -1;
+      }
+    }
+    connections_.erase(
+        std::remove_if(connections_.begin(), connections_.end(),
+                       [](Connection const& c) { return c.fd < 0; }),
+        connections_.end());
+    if (fds[1].revents & POLLIN) Accept();
+  }
+  for (Connection const& connection : connections_) {
+    close(connection.fd);
+  }
+  connections_.clear();
+}
+
+// Take every pending connection, past the limit they are closed right away
+void Exporter::Accept() {
+  for (;;) {
+    int fd = accept4(listen_fd_, nullptr, nullptr,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    if (connections_.size() >= kMaxConnections) {
+      close(fd);
+      continue;
+    }
+    Connection& connection = connections_.emplace_back();
+    connection.fd = fd;
+    connection.opened = std::chrono::steady_clock::now();
+  }
+}
+
+// Read the request headers, false closes the connection
+// Once they are complete the response is picked and sending starts.
+bool Exporter::Receive(Connection& connection) {
+  char buffer[1024];
+  for (;;) {
+    ssize_t length = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (length == 0) return false;
+    if (length < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    connection.request.append(buffer, length);
+    std::string_view request{connection.request};
+    if (request.find("\r\n\r\n") != std::string_view::npos ||
+        request.find("\n\n") != std::string_view::npos) {
+      connection.response = Respond(request);
+      return Send(connection);
+    }
+    if (connection.request.size() > kMaxRequest) return false;
+  }
+}
+
+// Write what the socket takes, false once all of it went or on an error
+bool Exporter::Send(Connection& connection) {
+  std::string const& response = *connection.response;
+  while (connection.sent < response.size()) {
+    ssize_t length =
+        send(connection.fd, response.data() + connection.sent,
+             response.size() - connection.sent, MSG_NOSIGNAL);
+    if (length < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    connection.sent += length;
+  }
+  return false;
+}
+
+// GET / or /metrics is the cached snapshot, anything else an error
+std::shared_ptr<std::string const> Exporter::Respond(
+    std::string_view request) const {
+  static auto const kNotFound = Error("404 Not Found");
+  static auto const kNotAllowed = Error("405 Method Not Allowed");
+  static auto const kUnavailable = Error("503 Service Unavailable");
+  std::string_view line = request.substr(0, request.find_first_of("\r\n"));
+  std::size_t space = line.find(' ');
+  if (line.substr(0, space) != "GET") return kNotAllowed;
+  std::string_view target =
+      space == std::string_view::npos ? "" : line.substr(space + 1);
+  target = target.substr(0, target.find_first_of(" ?"));
+  if (target != "/" && target != "/metrics") return kNotFound;
+  auto response = std::atomic_load(&response_);
+  return response != nullptr ? response : kUnavailable;
+}
+
+// Stop the server thread and release the sockets
+void Exporter::Close() {
+  if (thread_.joinable()) {
+    std::uint64_t stop{1};
+    static_cast<void>(write(wake_fd_, &stop, sizeof(stop)));
+    thread_.join();
+  }
+  for (int* fd : {&listen_fd_, &wake_fd_}) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+  }
+  if (!socket_path_.empty()) {
+    unlink(socket_path_.c_str());
+    socket_path_.clear();
+  }
+}
@@ -0,0 +1,32 @@
+#include "field_sources.h"
+
+#include "process.h"
+#include "snapshot.h"
+
+// DONE: Union of the sources behind fields, ex.: kStat for cpu and ram
+unsigned FieldSources::Sources(unsigned fields, unsigned loaded) {
+  unsigned sources{kNone};
+  for (Entry const& entry : kEntries) {
+    if ((fields & entry.field) == 0) continue;
+    if (entry.lifetime == Lifetime::kProcess && (loaded & entry.field)) {
+      continue;
+    }
+    sources |= entry.source;
+  }
+  return sources;
+}
+
+// DONE: Every key ranks by a column of the stat sample
+// cpu: utime + stime deltas, mem: rss, time: utime + stime, age: starttime
+unsigned FieldSources::Sources(SortKey key) {
+  switch (key) {
+    case SortKey::kCpu:
+    case SortKey::kRam:
+    case SortKey::kCpuTime:
+    case SortKey::kAge:
+      return kStat;
+    case SortKey::kPid:
+      return kNone;
+  }
+  return kStat;
+}
@@ -1,16 +1,22 @@
 #include "format.h"
 
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
 #include <string>
 
 // DONE: Complete this helper function
 // INPUT: Long int measuring seconds
 // OUTPUT: HH:MM:SS
 std::string Format::ElapsedTime(long seconds) {
-  std::stringstream r;
-  r.fill('0');
-  r << std::setw(2) << (seconds / 3600) << ":" << std::setw(2)
-    << ((seconds / 60) % 60) << ":" << std::setw(2) << (seconds % 60);
-  return r.str();
+  char buffer[32];
+  return std::string(buffer, ElapsedTime(seconds, buffer, sizeof(buffer)));
+}
+
+// DONE: Same into a caller's buffer, returns the length written
+// The hours keep growing past 99, ex.: 123:04:05
+int Format::ElapsedTime(long seconds, char* buffer, std::size_t size) {
+  int length = std::snprintf(buffer, size, "%02ld:%02ld:%02ld", seconds / 3600,
+                             (seconds / 60) % 60, seconds % 60);
+  return std::clamp<int>(length, 0, size == 0 ? 0 : size - 1);
 }
@@ -0,0 +1,87 @@
+#include "frame.h"
+
+#include <curses.h>
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace {
+// No cell is ever composed as this, so every cell differs after Resize()
+chtype constexpr kUndrawn{~chtype{0}};
+}  // namespace
+
+// DONE: Change the grid size, the next flush redraws everything
+void Frame::Resize(int rows, int columns) {
+  rows_ = std::max(rows, 0);
+  columns_ = std::max(columns, 0);
+  next_.assign(static_cast<std::size_t>(rows_) * columns_, ' ');
+  drawn_.assign(next_.size(), kUndrawn);
+}
+
+int Frame::Rows() const { return rows_; }
+
+int Frame::Columns() const { return columns_; }
+
+// DONE: Blank the frame being composed, the drawn one is kept for Flush
+void Frame::Clear() { std::fill(next_.begin(), next_.end(), chtype{' '}); }
+
+void Frame::Put(int row, int column, std::string_view text,
+                chtype attributes) {
+  if (row < 0 || row >= rows_ || column >= columns_) return;
+  chtype* cells = &next_[static_cast<std::size_t>(row) * columns_];
+  for (char c : text) {
+    if (column >= columns_) break;
+    if (column >= 0) {
+      cells[column] = static_cast<unsigned char>(c) | attributes;
+    }
+    ++column;
+  }
+}
+
+void Frame::Put(int row, int column, chtype cell) {
+  if (row < 0 || row >= rows_ || column < 0 || column >= columns_) return;
+  next_[static_cast<std::size_t>(row) * columns_ + column] = cell;
+}
+
+// DONE: Draw a line border across the full width, like box(3X) on a window
+void Frame::Box(int top, int bottom) {
+  int right = columns_ - 1;
+  for (int column = 1; column < right; ++column) {
+    Put(top, column, ACS_HLINE);
+    Put(bottom, column, ACS_HLINE);
+  }
+  for (int row = top + 1; row < bottom; ++row) {
+    Put(row, 0, ACS_VLINE);
+    Put(row, right, ACS_VLINE);
+  }
+  Put(top, 0, ACS_ULCORNER);
+  Put(top, right, ACS_URCORNER);
+  Put(bottom, 0, ACS_LLCORNER);
+  Put(bottom, right, ACS_LRCORNER);
+}
+
+// DONE: Copy the changed runs of cells to the window
+// Unchanged cells are not touched, so curses has nothing to send for them
+// and a steady screen costs no terminal output at all.
+int Frame::Flush(WINDOW* window) {
+  int written{0};
+  for (int row = 0; row < rows_; ++row) {
+    std::size_t offset = static_cast<std::size_t>(row) * columns_;
+    chtype const* next = &next_[offset];
+    chtype* drawn = &drawn_[offset];
+    for (int column = 0; column < columns_;) {
+      if (next[column] == drawn[column]) {
+        ++column;
+        continue;
+      }
+      int end = column + 1;
+      while (end < columns_ && next[end] != drawn[end]) ++end;
+      mvwaddchnstr(window, row, column, next + column, end - column);
+      std::copy(next + column, next + end, drawn + column);
+      written += end - column;
+      column = end;
+    }
+  }
+  return written;
+}
@@ -0,0 +1,141 @@
+#include "instrumentation.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace Instrumentation {
+#if MONITOR_INSTRUMENT
+Counters counters;
+#endif
+
+char const* Name(Phase phase) {
+  switch (phase) {
+    case kEnumerate:
+      return "enumerate";
+    case kParse:
+      return "parse";
+    case kRank:
+      return "rank";
+    case kResolve:
+      return "resolve";
+    case kRender:
+      return "render";
+    default:
+      return "";
+  }
+}
+
+// DONE: Read every counter, zeros when compiled out
+Totals Now() {
+  Totals totals;
+#if MONITOR_INSTRUMENT
+  for (int phase = 0; phase < kPhases; ++phase) {
+    totals.phase_ns[phase] =
+        counters.phase_ns[phase].load(std::memory_order_relaxed);
+  }
+  totals.files_opened = counters.files_opened.load(std::memory_order_relaxed);
+  totals.bytes_read = counters.bytes_read.load(std::memory_order_relaxed);
+  totals.allocations = counters.allocations.load(std::memory_order_relaxed);
+#endif
+  return totals;
+}
+
+Totals Delta(Totals const& later, Totals const& earlier) {
+  Totals delta;
+  for (int phase = 0; phase < kPhases; ++phase) {
+    delta.phase_ns[phase] = later.phase_ns[phase] - earlier.phase_ns[phase];
+  }
+  delta.files_opened = later.files_opened - earlier.files_opened;
+  delta.bytes_read = later.bytes_read - earlier.bytes_read;
+  delta.allocations = later.allocations - earlier.allocations;
+  return delta;
+}
+}  // namespace Instrumentation
+
+#if MONITOR_INSTRUMENT
+// Every allocation in the process goes through here. The whole set is
+// replaced, array and aligned forms included, so that no new/delete pair
+// mixes this allocator with the library's.
+namespace {
+void* Allocate(std::size_t size, std::size_t alignment) {
+  Instrumentation::counters.allocations.fetch_add(1,
+                                                  std::memory_order_relaxed);
+  if (size == 0) size = 1;
+  if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+  // aligned_alloc wants a multiple of the alignment
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+}
+
+void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+  if (void* memory = Allocate(size, alignment)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+constexpr std::size_t kDefault{alignof(std::max_align_t)};
+}  // namespace
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, kDefault); }
+void* operator new[](std::size_t size) {
+  return AllocateOrThrow(size, kDefault);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+  return Allocate(size, kDefault);
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+  return Allocate(size, kDefault);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   std::nothrow_t const&) noexcept {
+  return Allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     std::nothrow_t const&) noexcept {
+  return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept {
+  std::free(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+  std::free(memory);
+}
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+  std::free(memory);
+}
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+  std::free(memory);
+}
+void operator delete(void* memory, std::nothrow_t const&) noexcept {
+  std::free(memory);
+}
+void operator delete[](void* memory, std::nothrow_t const&) noexcept {
+  std::free(memory);
+}
+void operator delete(void* memory, std::align_val_t,
+                     std::nothrow_t const&) noexcept {
+  std::free(memory);
+}
+void operator delete[](void* memory, std::align_val_t,
+                       std::nothrow_t const&) noexcept {
+  std::free(memory);
+}
+#endif
@@ -0,0 +1,21 @@
+#include "keyed_lines.h"
+
+#include <cstddef>
+#include <string_view>
+
+#include "scanner.h"
+
+// ex.: "VmRSS:	    5824 kB\n..." -> "VmRSS", 5824
+// A line without a number after the colon yields 0, ex.: "Name:	bash"
+bool KeyedLines::Next(std::string_view& content, std::string_view& key,
+                      long& value) {
+  Scanner lines(content);
+  std::string_view line = lines.Line();
+  content = lines.Rest();
+  std::size_t colon = line.find(':');
+  if (colon == std::string_view::npos) return false;
+  key = line.substr(0, colon);
+  value = 0;
+  Scanner(line.substr(colon + 1)).Number(value);
+  return true;
+}
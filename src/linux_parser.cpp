@@ -1,33 +1,87 @@
 #include "linux_parser.h"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
-#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "instrumentation.h"
+#include "keyed_lines.h"
+#include "pid_directory.h"
+#include "proc_file.h"
+#include "scanner.h"
+#include "user_cache.h"
+
+namespace {
+std::string proc_directory{LinuxParser::kProcDirectory};
+std::string password_path{LinuxParser::kPasswordPath};
+std::atomic<unsigned> roots_generation{0};  // bumped by SetRoots
+
+// A file of the proc tree kept open by the calling thread, see ProcFile
+// Reopened under the new root after SetRoots().
+class KeptFile {
+ public:
+  explicit KeptFile(std::string const& filename) : filename_(filename) {}
+
+  std::string_view Read() {
+    unsigned generation = roots_generation.load();
+    if (file_ == nullptr || generation_ != generation) {
+      file_ = std::make_unique<ProcFile>(LinuxParser::ProcDirectory() +
+                                         filename_);
+      generation_ = generation;
+    }
+    return file_->Read();
+  }
+
+ private:
+  std::string filename_;
+  unsigned generation_{0};
+  std::unique_ptr<ProcFile> file_;
+};
+}  // namespace
+
+// DONE: Point the readers at another proc tree and passwd file
+// ex.: SetRoots("/tmp/fake/proc", "/tmp/fake/passwd")
+void LinuxParser::SetRoots(std::string proc, std::string passwd) {
+  if (!proc.empty() && proc.back() != '/') {
+    proc += '/';
+  }
+  proc_directory = std::move(proc);
+  password_path = std::move(passwd);
+  ++roots_generation;
+}
+
+std::string const& LinuxParser::ProcDirectory() { return proc_directory; }
+
+std::string const& LinuxParser::PasswordPath() { return password_path; }
+
 // DONE: An example of how to read data from the filesystem
 // grep -i pretty_name /etc/os-release
 // ex.: PRETTY_NAME="Arch Linux"
 std::string LinuxParser::OperatingSystem() {
-  std::string line, key, value;
-  std::ifstream filestream(kOSPath);
-  if (filestream.is_open()) {
-    while (std::getline(filestream, line)) {
-      std::replace(line.begin(), line.end(), ' ', '_');
-      std::replace(line.begin(), line.end(), '=', ' ');
-      std::replace(line.begin(), line.end(), '"', ' ');
-      std::istringstream linestream(line);
-      while (linestream >> key >> value) {
-        if (key == "PRETTY_NAME") {
-          std::replace(value.begin(), value.end(), '_', ' ');
-          return value;
-        }
-      }
+  ProcFile file(kOSPath);
+  Scanner content(file.Read());
+  while (!content.Empty()) {
+    Scanner line(content.Line());
+    if (line.Until('=') != "PRETTY_NAME") continue;
+    std::string_view value = line.Rest();
+    if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') &&
+        value.back() == value.front()) {
+      value = value.substr(1, value.size() - 2);
     }
+    return std::string(value);
   }
-  return value;
+  return "";
 }
 
 // DONE: An example of how to read data from the filesystem
@@ -35,143 +89,335 @@ std::string LinuxParser::OperatingSystem() {
 // Linux version 5.5.7-arch1-1 (linux@archlinux) (gcc version 9.2.1 20200130
 // (Arch Linux 9.2.1+20200130-2)) #1 SMP PREEMPT Sat, 29 Feb 2020 19:06:02 +0000
 std::string LinuxParser::Kernel() {
-  std::string os, version, kernel, line;
-  std::ifstream stream(kProcDirectory + kVersionFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream linestream(line);
-    linestream >> os >> version >> kernel;
-  }
-  return kernel;
+  ProcFile file(ProcDirectory() + kVersionFilename);
+  Scanner line(file.Read());
+  line.Word();  // Linux
+  line.Word();  // version
+  return std::string(line.Word());
 }
 
-// DONE: Update this to use std::filesystem
-// ls /proc/ | grep '[0-9]' | sort -V
+// DONE: Return the pids listed in /proc
+// Read with getdents64, see PidDirectory. A tick keeps its own
+// PidDirectory open instead of paying for the open here.
 std::vector<int> LinuxParser::Pids() {
   std::vector<int> pids;
-  std::size_t len = kProcDirectory.length();
-  for (const auto& dir : std::filesystem::directory_iterator(kProcDirectory)) {
-    std::string proc_path = dir.path();
-    std::string proc_id = proc_path.substr(len);
-    if (std::all_of(proc_id.begin(), proc_id.end(), isdigit)) {
-      pids.push_back(std::stoi(proc_id));
-    }
-  }
+  PidDirectory(ProcDirectory()).Read(pids);
   return pids;
 }
 
+namespace {
+// Row key match, ex.: "procs_running 15" starts with "procs_running "
+bool HasKey(std::string_view line, std::string_view key) {
+  return line.size() > key.size() && line.compare(0, key.size(), key) == 0 &&
+         (line[key.size()] == ' ' || line[key.size()] == ':');
+}
+
+// Value of a "key value" row, 0 when it has none
+long Value(std::string_view line, std::string_view key) {
+  long value{0};
+  Scanner(line.substr(key.size() + 1)).Number(value);
+  return value;
+}
+}  // namespace
+
 // DONE: Read and return the system memory utilization
+// The file stays open for the next call on this thread
+float LinuxParser::MemoryUtilization() {
+  thread_local KeptFile file(kMeminfoFilename);
+  return MemoryUtilization(file.Read());
+}
+
 // grep -i memtotal /proc/meminfo # fixed
 // grep -i memfree  /proc/meminfo
 // grep -i buffers  /proc/meminfo
-float LinuxParser::MemoryUtilization() {
-  float mem_total{1};
-  float mem_free{0};
-  float buffers{0};
-  std::string token;
-  std::ifstream stream(kProcDirectory + kMeminfoFilename);
-  if (stream.is_open()) {
-    while (stream >> token) {
-      if (token == "MemTotal:") {
-        if (stream >> token) mem_total = std::stof(token);
-      } else if (token == "MemFree:") {
-        if (stream >> token) mem_free = std::stof(token);
-      } else if (token == "Buffers:") {
-        if (stream >> token) buffers = std::stof(token);
-      }
-    }
-  }
-  return 1 - mem_free / (mem_total - buffers);
+// ex.: MemTotal:       16337748 kB
+float LinuxParser::MemoryUtilization(std::string_view meminfo) {
+  MemInfo memory;
+  Memory(meminfo, memory);
+  return memory.Utilization();
+}
+
+// DONE: Parse the /proc/meminfo fields the memory bar shows
+// SwapFree is the last of them, the scan stops there
+bool LinuxParser::Memory(std::string_view meminfo, MemInfo& memory) {
+  static KeyedLines::Key<MemInfo> constexpr kKeys[] = {
+      {"MemTotal", &MemInfo::total},        {"MemFree", &MemInfo::free},
+      {"MemAvailable", &MemInfo::available}, {"Buffers", &MemInfo::buffers},
+      {"Cached", &MemInfo::cached},          {"SwapTotal", &MemInfo::swap_total},
+      {"SwapFree", &MemInfo::swap_free}};
+  return KeyedLines::Parse(meminfo, kKeys, memory) > 0;
+}
+
+// DONE: Share of memory neither free nor in buffers
+float LinuxParser::MemInfo::Utilization() const {
+  long usable = total - buffers;
+  return usable > 0 ? 1 - static_cast<float>(free) / usable : 0;
 }
 
 // DONE: Read and return the system uptime
+// The file stays open for the next call on this thread
+long LinuxParser::UpTime() {
+  thread_local KeptFile file(kUptimeFilename);
+  return UpTime(file.Read());
+}
+
 // cat /proc/uptime
 // ex: 769125.59 4139832.62
-long LinuxParser::UpTime() {
-  std::string line, token;
-  std::ifstream stream(kProcDirectory + kUptimeFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream stream(line);
-    if (stream >> token) {
-      return stoi(token);
-    }
+long LinuxParser::UpTime(std::string_view uptime) {
+  long seconds{0};
+  Scanner(uptime).Number(seconds);
+  return seconds;
+}
+
+// cat /proc/loadavg
+// ex.: 0.20 0.18 0.12 1/80 11206
+int LinuxParser::LastPid(std::string_view loadavg) {
+  Scanner fields(loadavg);
+  for (int skipped = 0; skipped < 4; ++skipped) {
+    if (fields.Word().empty()) return -1;
   }
-  return 0;
+  int pid{-1};
+  return fields.Number(pid) ? pid : -1;
+}
+
+// DONE: Read the time since boot at nanosecond resolution
+// The same clock as /proc/uptime, without the file read and the rounding
+// to hundredths of a second.
+long long LinuxParser::BootTime() {
+  timespec now{};
+  clock_gettime(CLOCK_BOOTTIME, &now);
+  return now.tv_sec * 1'000'000'000LL + now.tv_nsec;
+}
+
+// DONE: Return CLK_TCK, asked of the system once
+long LinuxParser::TicksPerSecond() {
+  static long const ticks_per_second = sysconf(_SC_CLK_TCK);
+  return ticks_per_second;
+}
+
+// DONE: Convert a jiffies delta over a nanosecond interval to a share
+// ex.: 10 ticks at 100 per second over 100 ms -> 1.0, one CPU busy
+float LinuxParser::CpuShare(long active_ticks, long long elapsed_ns) {
+  if (elapsed_ns <= 0) return 0;
+  return static_cast<float>(static_cast<double>(active_ticks) * 1e9 /
+                            (static_cast<double>(elapsed_ns) *
+                             TicksPerSecond()));
 }
 
 // DONE: Read and return the number of jiffies for the system
-long LinuxParser::Jiffies() { return UpTime() * sysconf(_SC_CLK_TCK); }
+long LinuxParser::Jiffies() {
+  return static_cast<long>(BootTime() / 1e9 * TicksPerSecond());
+}
 
 // DONE: Read and return the number of active jiffies for a PID
 // cat /proc/$pid/stat
 long LinuxParser::ActiveJiffies(int pid) {
-  long jiffies{0};
-  std::string line, token;
-  std::vector<std::string> values;
-  std::ifstream stream(LinuxParser::kProcDirectory + std::to_string(pid) +
-                       LinuxParser::kStatFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream linestream(line);
-    while (linestream >> token) {
-      values.push_back(token);
+  PidStat stat;
+  return Stat(pid, stat) ? stat.ActiveJiffies() : 0;
+}
+
+long LinuxParser::PidStat::ActiveJiffies() const {
+  return utime + stime + cutime + cstime;
+}
+
+namespace {
+// Reads a stat file once into a reusable per-thread buffer
+// ex.: 1032 (kaccess) S 1014 1014 1014 0 -1 4194304 2464 25 11 0 2037 2332 0 0
+// 20 0 3 0 1984 298430464 3121 18446744073709551615 94680157405184 ...
+bool ReadStat(char const* path, LinuxParser::PidStat& stat) {
+  thread_local char buffer[4096];
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  MONITOR_COUNT_OPEN();
+  ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+  ::close(fd);
+  if (size <= 0) {
+    return false;
+  }
+  MONITOR_COUNT_READ(size);
+  return LinuxParser::Stat({buffer, static_cast<std::size_t>(size)}, stat);
+}
+}  // namespace
+
+// DONE: Parse the contents of a stat file
+// comm is whatever the process named itself, ex.: "(sd-pam)" or "(a) b)",
+// so it is delimited by the first '(' and the last ')'.
+bool LinuxParser::Stat(std::string_view content, PidStat& stat) {
+  std::size_t open = content.find('(');
+  std::size_t close = content.rfind(')');
+  if (open == std::string_view::npos || close == std::string_view::npos ||
+      close < open) {
+    return false;
+  }
+  std::size_t length = std::min(close - open - 1, sizeof(stat.comm) - 1);
+  std::memcpy(stat.comm, content.data() + open + 1, length);
+  stat.comm[length] = '\0';
+
+  // Fields after comm, numbered as in proc(5): state is (3), rss is (24)
+  Scanner rest(content.substr(close + 1));
+  std::string_view state = rest.Word();
+  if (state.empty()) {
+    return false;
+  }
+  stat.state = state.front();
+  long long fields[25]{};
+  for (int field = 4; field <= 24; ++field) {
+    if (!rest.Number(fields[field])) {
+      return false;
     }
   }
-  if (values.size() > 21) {
-    long user = std::stol(values[13]);
-    long kernel = std::stol(values[14]);
-    long children_user = std::stol(values[15]);
-    long children_kernel = std::stol(values[16]);
-    jiffies = user + kernel + children_user + children_kernel;
+  stat.ppid = static_cast<int>(fields[4]);
+  stat.utime = fields[14];
+  stat.stime = fields[15];
+  stat.cutime = fields[16];
+  stat.cstime = fields[17];
+  stat.num_threads = fields[20];
+  stat.starttime = fields[22];
+  stat.vsize = static_cast<unsigned long>(fields[23]);
+  stat.rss = fields[24];
+  return true;
+}
+
+// DONE: Read /proc/$pid/stat
+bool LinuxParser::Stat(int pid, PidStat& stat) {
+  char path[PATH_MAX];
+  int written = std::snprintf(path, sizeof(path), "%s%d%s",
+                              ProcDirectory().c_str(), pid,
+                              kStatFilename.c_str());
+  if (written < 0 || static_cast<std::size_t>(written) >= sizeof(path)) {
+    return false;
+  }
+  return ReadStat(path, stat);
+}
+
+// DONE: Read one thread of a process, same fields as for the process
+// cat /proc/$pid/task/$tid/stat
+bool LinuxParser::Stat(int pid, int tid, PidStat& stat) {
+  char path[PATH_MAX];
+  int written = std::snprintf(path, sizeof(path), "%s%d%s/%d%s",
+                              ProcDirectory().c_str(), pid,
+                              kTaskDirectory.c_str(), tid,
+                              kStatFilename.c_str());
+  if (written < 0 || static_cast<std::size_t>(written) >= sizeof(path)) {
+    return false;
   }
-  return jiffies;
+  return ReadStat(path, stat);
 }
 
 // DONE: Read and return the number of active jiffies for the system
 long LinuxParser::ActiveJiffies() {
-  std::vector<std::string> time = CpuUtilization();
-  return (stol(time[CPUStates::kUser_]) + stol(time[CPUStates::kNice_]) +
-          stol(time[CPUStates::kSystem_]) + stol(time[CPUStates::kIRQ_]) +
-          stol(time[CPUStates::kSoftIRQ_]) + stol(time[CPUStates::kSteal_]) +
-          stol(time[CPUStates::kGuest_]) + stol(time[CPUStates::kGuestNice_]));
+  StatSnapshot snapshot;
+  Stat(snapshot);
+  return snapshot.cpu.Active();
 }
 
 // DONE: Read and return the number of idle jiffies for the system
 long LinuxParser::IdleJiffies() {
-  std::vector<std::string> time = CpuUtilization();
-  return (stol(time[CPUStates::kIdle_]) + stol(time[CPUStates::kIOwait_]));
+  StatSnapshot snapshot;
+  Stat(snapshot);
+  return snapshot.cpu.Idle();
 }
 
-// DONE: Read and return CPU utilization
-// grep -i cpu /proc/stat | head -n 1 # we are taking first raw
+long LinuxParser::CpuTimes::Active() const {
+  return states[kUser_] + states[kNice_] + states[kSystem_] + states[kIRQ_] +
+         states[kSoftIRQ_] + states[kSteal_] + states[kGuest_] +
+         states[kGuestNice_];
+}
+
+long LinuxParser::CpuTimes::Idle() const {
+  return states[kIdle_] + states[kIOwait_];
+}
+
+// Guest time is part of user, here and in a process's utime
+long LinuxParser::CpuTimes::Busy() const {
+  return states[kUser_] + states[kNice_] + states[kSystem_];
+}
+
+namespace {
+// Fills as many cpu states as the row carries, older kernels have fewer
+void ParseCpuRow(std::string_view row, LinuxParser::CpuTimes& times) {
+  times = {};
+  Scanner states(row);
+  for (auto& state : times.states) {
+    if (!states.Number(state)) break;
+  }
+}
+
+// Appends one cpuN row to the columns, growing them on the first pass only
+void ParseCoreRow(std::string_view row, LinuxParser::CoreTimes& cores) {
+  std::size_t core = cores.count++;
+  Scanner states(row);
+  for (auto& column : cores.states) {
+    if (column.size() < cores.count) column.resize(cores.count);
+    long value{0};
+    states.Number(value);
+    column[core] = value;
+  }
+}
+}  // namespace
+
+// DONE: Read every row of /proc/stat once
+// cat /proc/stat
 // ex.:
 //
 // cpu  32078232 190062 16055442 411697204 576168 1325311 732490 0 0 0
 // cpu0 4058841 25067 1996131 51452178 71971 122647 118563 0 0 0
-// cpu1 4070498 29646 1960711 51509998 65775 126339 87034 0 0 0
-// cpu2 4064896 23092 1887298 51608532 79775 122624 76350 0 0 0
-// cpu3 4053549 22922 1888345 51609499 70470 125814 78469 0 0 0
-// cpu4 4057999 24392 1893796 51598624 70712 154534 63136 0 0 0
-// cpu5 4109807 21883 1966474 51486901 70796 133167 66831 0 0 0
-// cpu6 3838859 23629 2354810 51244115 73119 208394 74889 0 0 0
-// cpu7 3823779 19427 2107875 51187353 73547 331789 167215 0 0 0
+// ...
+// intr 1650384925 9 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0
+// ctxt 2766862541
+// btime 1583076582
+// processes 31761886
+// procs_running 15
+// procs_blocked 0
+// The file stays open for the next call on this thread, so CpuUtilization,
+// the jiffies and the process counts cost one pread each
+bool LinuxParser::Stat(StatSnapshot& snapshot) {
+  thread_local KeptFile file(kStatFilename);
+  return Stat(file.Read(), snapshot);
+}
 
+bool LinuxParser::Stat(std::string_view stat, StatSnapshot& snapshot) {
+  if (stat.empty()) {
+    return false;
+  }
+  // Keep the columns of cores, they are refilled every tick
+  snapshot.cores.count = 0;
+  Scanner rows(stat);
+  while (!rows.Empty()) {
+    std::string_view line = rows.Line();
+    if (line.compare(0, 3, "cpu") == 0) {
+      std::size_t space = line.find(' ');
+      if (space == std::string_view::npos) continue;
+      if (space == 3) {
+        ParseCpuRow(line.substr(space), snapshot.cpu);
+      } else {
+        ParseCoreRow(line.substr(space), snapshot.cores);
+      }
+    } else if (HasKey(line, "ctxt")) {
+      snapshot.context_switches = Value(line, "ctxt");
+    } else if (HasKey(line, "processes")) {
+      snapshot.processes = Value(line, "processes");
+    } else if (HasKey(line, "procs_running")) {
+      snapshot.procs_running = Value(line, "procs_running");
+    } else if (HasKey(line, "procs_blocked")) {
+      snapshot.procs_blocked = Value(line, "procs_blocked");
+    }
+  }
+  return true;
+}
+
+// DONE: Read and return CPU utilization
+// grep -i cpu /proc/stat | head -n 1 # we are taking first raw
+// ex.:
+// cpu  32078232 190062 16055442 411697204 576168 1325311 732490 0 0 0
 std::vector<std::string> LinuxParser::CpuUtilization() {
-  std::string line, token;
   std::vector<std::string> values;
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream linestream(line);
-      while (linestream >> token) {
-        if (token == "cpu") {
-          while (linestream >> token) {
-            values.push_back(token);
-          }
-          return values;
-        }
-      }
+  StatSnapshot snapshot;
+  if (Stat(snapshot)) {
+    for (long state : snapshot.cpu.states) {
+      values.push_back(std::to_string(state));
     }
   }
   return values;
@@ -181,110 +427,125 @@ std::vector<std::string> LinuxParser::CpuUtilization() {
 // grep -i processes /proc/stat
 // processes 31761886
 int LinuxParser::TotalProcesses() {
-  std::string line, k, v;
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream stream(line);
-      while (stream >> k >> v) {
-        if (k == "processes") {
-          return std::stoi(v);
-        }
-      }
-    }
-  }
-  return 0;
+  StatSnapshot snapshot;
+  Stat(snapshot);
+  return snapshot.processes;
 }
 
 // DONE: Read and return the number of running processes
 // grep -i procs_running /proc/stat
 // ex.: procs_running 15
 int LinuxParser::RunningProcesses() {
-  std::string line;
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::string k, v;
-      while (stream >> k >> v) {
-        if (k == "procs_running") {
-          return std::stoi(v);
-        }
-      }
-    }
-  }
-  return 0;
+  StatSnapshot snapshot;
+  Stat(snapshot);
+  return snapshot.procs_running;
 }
 
 // DONE: Read and return the command associated with a process
-// cat /proc/$pid/cmdline
-// ex.: /usr/bin/kaccess
+// cat /proc/$pid/cmdline | tr '\0' ' '
+// arguments are NUL separated, ex.: /usr/bin/kaccess\0--daemon\0
 std::string LinuxParser::Command(int pid) {
+  char path[PATH_MAX];
+  int written = std::snprintf(path, sizeof(path), "%s%d%s",
+                              ProcDirectory().c_str(), pid,
+                              kCmdlineFilename.c_str());
+  if (written < 0 || static_cast<std::size_t>(written) >= sizeof(path)) {
+    return "";
+  }
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return "";
+  }
+  MONITOR_COUNT_OPEN();
+  // The returned string is the only allocation, most command lines fit
+  // the first read
   std::string line;
-  std::ifstream stream(LinuxParser::kProcDirectory + std::to_string(pid) +
-                       LinuxParser::kCmdlineFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    return line;
+  char buffer[4096];
+  ssize_t size{0};
+  while ((size = ::read(fd, buffer, sizeof(buffer))) > 0) {
+    MONITOR_COUNT_READ(size);
+    line.append(buffer, size);
   }
-  return "";
+  ::close(fd);
+  std::replace(line.begin(), line.end(), '\0', ' ');
+  line.erase(line.find_last_not_of(' ') + 1);
+  return line;
+}
+
+// DONE: Read the /proc/[pid]/status fields the monitor uses, in one pass
+// Threads comes last, the scan stops there
+// ex.: Uid:	1000	1000	1000	1000
+//      VmRSS:	    5824 kB
+bool LinuxParser::Status(int pid, PidStatus& status) {
+  thread_local char buffer[4096];
+  char path[PATH_MAX];
+  int written = std::snprintf(path, sizeof(path), "%s%d%s",
+                              ProcDirectory().c_str(), pid,
+                              kStatusFilename.c_str());
+  if (written < 0 || static_cast<std::size_t>(written) >= sizeof(path)) {
+    return false;
+  }
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  MONITOR_COUNT_OPEN();
+  ssize_t size = ::read(fd, buffer, sizeof(buffer));
+  ::close(fd);
+  if (size <= 0) {
+    return false;
+  }
+  MONITOR_COUNT_READ(size);
+  Status({buffer, static_cast<std::size_t>(size)}, status);
+  return true;
 }
 
-// DONE: Read and return the memory used by a process
-// TODO: Merge with ::Uid
-// grep -i vmsize /proc/$pid/status
-// ex.: VmSize:	  291436 kB
+// DONE: Parse the contents of a status file
+void LinuxParser::Status(std::string_view content, PidStatus& status) {
+  static KeyedLines::Key<PidStatus> constexpr kKeys[] = {
+      {"Uid", &PidStatus::uid},
+      {"VmSize", &PidStatus::vm_size},
+      {"VmRSS", &PidStatus::vm_rss},
+      {"Threads", &PidStatus::threads}};
+  status = PidStatus{};
+  KeyedLines::Parse(content, kKeys, status);
+}
+
+// DONE: Read and return the memory used by a process, resident MB
+// grep -i vmrss /proc/$pid/status
 std::string LinuxParser::Ram(int pid) {
-  std::string token;
-  std::ifstream stream(LinuxParser::kProcDirectory + std::to_string(pid) +
-                       LinuxParser::kStatusFilename);
-  if (stream.is_open()) {
-    while (stream >> token) {
-      if (token == "VmSize:") {
-        if (stream >> token) {
-          return std::to_string(std::stoi(token) / 1024);
-        }
-      }
-    }
+  PidStatus status;
+  if (!Status(pid, status)) {
+    return "0";
   }
-  return "0";
+  return std::to_string(status.vm_rss / 1024);
 }
 
 // DONE: Read and return the user ID associated with a process
-// TODO: Merge with ::Ram
 // grep -i uid /proc/$pid/status
-// ex.: Uid:	1000	1000	1000	1000
 std::string LinuxParser::Uid(int pid) {
-  std::string token;
-  std::ifstream stream(LinuxParser::kProcDirectory + std::to_string(pid) +
-                       LinuxParser::kStatusFilename);
-  if (stream.is_open()) {
-    while (stream >> token) {
-      if (token == "Uid:") {
-        if (stream >> token) {
-          return token;
-        }
-      }
-    }
+  PidStatus status;
+  if (!Status(pid, status) || status.uid < 0) {
+    return "";
   }
-  return "";
+  return std::to_string(status.uid);
 }
 
 // DONE: Read and return the user associated with a process
-// grep -i x:$uid /etc/passwd
+// /etc/passwd is parsed once into a uid -> name map, see UserCache
 // ex.: git:x:975:975:git daemon user:/:/usr/bin/git-shell
 std::string LinuxParser::User(int pid) {
-  std::ifstream stream(LinuxParser::kPasswordPath);
-  if (stream.is_open()) {
-    std::string line;
-    std::string token = "x:" + Uid(pid);
-    while (std::getline(stream, line)) {
-      auto marker = line.find(token);
-      if (marker != std::string::npos) {
-        return line.substr(0, marker - 1);
-      }
-    }
+  PidStatus status;
+  if (!Status(pid, status) || status.uid < 0) {
+    return "0";
   }
-  return "0";
+  return UserName(static_cast<int>(status.uid));
+}
+
+// DONE: Resolve a user ID through the process-wide passwd cache
+std::string LinuxParser::UserName(int uid) {
+  static UserCache users(PasswordPath());
+  return users.Name(uid);
 }
 
 // DONE: Read and return the uptime of a process
@@ -295,18 +556,6 @@ std::string LinuxParser::User(int pid) {
 // 94680157421016 94680157421584 94680163794944 140725716625949 140725716625966
 // 140725716625966 140725716627431 0
 long int LinuxParser::UpTime(int pid) {
-  long int time{0};
-  std::string token;
-  std::ifstream stream(LinuxParser::kProcDirectory + std::to_string(pid) +
-                       LinuxParser::kStatFilename);
-  if (stream.is_open()) {
-    for (int i = 0; stream >> token; ++i) {
-      if (i == 13) {
-        time = std::stol(token);
-        time /= sysconf(_SC_CLK_TCK);
-        return time;
-      }
-    }
-  }
-  return time;
+  PidStat stat;
+  return Stat(pid, stat) ? stat.utime / TicksPerSecond() : 0;
 }
@@ -1,7 +1,74 @@
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "batch_output.h"
+#include "exporter.h"
+#include "linux_parser.h"
 #include "ncurses_display.h"
+#include "options.h"
+#include "recorder.h"
+#include "replayer.h"
+#include "sampler.h"
+#include "snapshot_source.h"
 #include "system.h"
 
-int main() {
-  System system;
-  NCursesDisplay::Display(system);
-}
\ No newline at end of file
+namespace {
+int Run(SnapshotSource& source, Options const& options) {
+  if (options.batch) {
+    return BatchOutput::Run(source, options);
+  }
+  if (!options.serve.empty()) {
+    Exporter exporter(options.serve);
+    std::string error;
+    if (!exporter.Open(error)) {
+      std::cerr << error << "\n";
+      return 1;
+    }
+    return exporter.Serve(source, options.iterations);
+  }
+  NCursesDisplay::Display(source);
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  std::string error;
+  if (!options.Parse(argc, argv, error)) {
+    std::cerr << error << "\n" << Options::Usage(argv[0]);
+    return 2;
+  }
+  LinuxParser::SetRoots(options.proc, options.passwd);
+
+  if (!options.replay.empty()) {
+    Replayer replayer(options.replay, options.speed);
+    if (!replayer.Load(error)) {
+      std::cerr << error << "\n";
+      return 1;
+    }
+    // As fast as possible is for piping a recording out, so keep every record
+    replayer.Lossless(options.batch && options.speed == 0);
+    return Run(replayer, options);
+  }
+
+  std::size_t rows = options.top == 0 ? std::numeric_limits<std::size_t>::max()
+                                      : options.top;
+  System system(options.workers);
+  system.MaxBackoff(options.max_backoff);
+  system.Filter(options.user);
+  system.ThreadBudget(options.thread_budget);
+  Sampler sampler(system, options.interval, rows, options.key,
+                  options.batch && options.record.empty()
+                      ? options.fields
+                      : kAllFields | (options.fields & kThreadsField));
+  Recorder recorder(options.record, options.record_mb << 20, rows);
+  if (!options.record.empty()) {
+    if (!recorder.Open(error)) {
+      std::cerr << error << "\n";
+      return 1;
+    }
+    sampler.RecordTo(&recorder);
+  }
+  return Run(sampler, options);
+}
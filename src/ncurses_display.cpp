@@ -2,110 +2,291 @@
 
 #include <curses.h>
 
-#include <chrono>
-#include <string>
-#include <thread>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
 #include <vector>
 
 #include "format.h"
-#include "system.h"
+#include "frame.h"
+#include "instrumentation.h"
+#include "snapshot.h"
+#include "snapshot_source.h"
 
 // 50 bars uniformly displayed from 0 - 100 %
-// 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-  std::string result{"0%"};
-  int size{50};
-  float bars{percent * size};
-
-  for (int i{0}; i < size; ++i) {
-    result += i <= bars ? '|' : ' ';
+// 2% is one bar(|), ex.: 0%|||||||||   ...   18.4/100%
+// Returns the length written, the text is cut to fit the buffer.
+int NCursesDisplay::ProgressBar(float percent, char* buffer,
+                                std::size_t size) {
+  char bars[kBars + 1];
+  float filled{percent * kBars};
+  for (int i{0}; i < kBars; ++i) {
+    bars[i] = i <= filled ? '|' : ' ';
   }
+  bars[kBars] = '\0';
 
-  std::string display{std::to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + std::to_string(percent * 100).substr(0, 3);
-  return result + " " + display + "/100%";
+  // The digits are cut, not rounded
+  char number[32];
+  std::snprintf(number, sizeof(number), "%f", percent * 100);
+  bool narrow = percent < 0.1 || percent == 1.0;
+  int length = std::snprintf(buffer, size, "0%%%s %s%.*s/100%%", bars,
+                             narrow ? " " : "", narrow ? 3 : 4, number);
+  return std::clamp<int>(length, 0, size == 0 ? 0 : size - 1);
 }
 
-void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
-  int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
-  mvwprintw(window, ++row, 2, "CPU: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2, "Memory: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(
-      window, ++row, 2,
-      ("Total Processes: " + std::to_string(system.TotalProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Running Processes: " + std::to_string(system.RunningProcesses()))
-                .c_str());
-  mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
-  wrefresh(window);
+// Ten shades from idle to busy, one cell per core
+char NCursesDisplay::HeatLevel(float utilization) {
+  static char constexpr kLevels[] = "_.:-=+*#%@";
+  int level = static_cast<int>(utilization * 10);
+  return kLevels[std::clamp(level, 0, 9)];
+}
+
+// DONE: Lines the heat strip wraps to in a frame this wide
+int NCursesDisplay::HeatStripRows(std::size_t cores, int width) {
+  std::size_t cells = std::max(1, width - kStripColumn - 2);
+  return static_cast<int>(
+      std::max<std::size_t>(1, (cores + cells - 1) / cells));
+}
+
+// DONE: Per-core heat strip, green below 50%, yellow below 80%, red above
+// ex.: __.:___@@#_____
+void NCursesDisplay::DisplayCores(std::vector<float> const& cores,
+                                  Frame& frame, int& row) {
+  int cells = std::max(1, frame.Columns() - kStripColumn - 2);
+  for (std::size_t i = 0; i < cores.size(); ++i) {
+    int column = static_cast<int>(i % cells);
+    if (column == 0 && i > 0) ++row;
+    int color = cores[i] < 0.5 ? 3 : cores[i] < 0.8 ? 4 : 5;
+    frame.Put(row, kStripColumn + column,
+              static_cast<chtype>(HeatLevel(cores[i])) | COLOR_PAIR(color));
+  }
 }
 
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+// DONE: What the memory bar leaves out, empty without meminfo figures
+// ex.: avail 9.8G  cache 4.1G  swap 0.2/2.0G
+int NCursesDisplay::MemoryFigures(LinuxParser::MemInfo const& memory,
+                                  char* buffer, std::size_t size) {
+  if (size == 0) return 0;
+  buffer[0] = '\0';
+  if (memory.total == 0) return 0;
+  auto gb = [](long kb) { return kb / (1024.0 * 1024.0); };
+  int length = std::snprintf(
+      buffer, size, "avail %.1fG  cache %.1fG  swap %.1f/%.1fG",
+      gb(memory.available), gb(memory.cached),
+      gb(memory.swap_total - memory.swap_free), gb(memory.swap_total));
+  return std::clamp<int>(length, 0, size - 1);
+}
+
+// DONE: The system box, from the top of the frame down
+void NCursesDisplay::DisplaySystem(Snapshot const& system, Frame& frame) {
+  char buffer[128];
+  auto bar = [&](float percent) {
+    return std::string_view(
+        buffer, ProgressBar(percent, buffer, sizeof(buffer)));
+  };
   int row{0};
-  int constexpr pid_column{2};
-  int constexpr user_column{pid_column + 10};
-  int constexpr cpu_column{user_column + 10};
-  int constexpr ram_column{cpu_column + 10};
-  int constexpr time_column{ram_column + 10};
-  int constexpr command_column{time_column + 10};
-  wattron(window, COLOR_PAIR(2));
-  mvwprintw(window, ++row, pid_column, "PID");
-  mvwprintw(window, row, user_column, "USER");
-  mvwprintw(window, row, cpu_column, "CPU[%%]");
-  mvwprintw(window, row, ram_column, "RAM[MB]");
-  mvwprintw(window, row, time_column, "TIME+");
-  mvwprintw(window, row, command_column, "COMMAND");
-  wattroff(window, COLOR_PAIR(2));
+  frame.Put(++row, 2, "OS: ");
+  frame.Put(row, 6, system.operating_system);
+  frame.Put(++row, 2, "Kernel: ");
+  frame.Put(row, 10, system.kernel);
+  frame.Put(++row, 2, "CPU: ");
+  frame.Put(row, kStripColumn, bar(system.cpu), COLOR_PAIR(1));
+  if (!system.cores.empty()) {
+    frame.Put(++row, 2, "Cores: ");
+    DisplayCores(system.cores, frame, row);
+  }
+  frame.Put(++row, 2, "Memory: ");
+  int length = ProgressBar(system.memory, buffer, sizeof(buffer));
+  frame.Put(row, kStripColumn, {buffer, static_cast<std::size_t>(length)},
+            COLOR_PAIR(1));
+  if (MemoryFigures(system.memory_info, buffer, sizeof(buffer)) > 0) {
+    frame.Put(row, kStripColumn + length + 2, buffer);
+  }
+  std::snprintf(buffer, sizeof(buffer), "Total Processes: %d",
+                system.total_processes);
+  frame.Put(++row, 2, buffer);
+  std::snprintf(buffer, sizeof(buffer), "Running Processes: %d",
+                system.running_processes);
+  frame.Put(++row, 2, buffer);
+  frame.Put(++row, 2, "Up Time: ");
+  Format::ElapsedTime(system.uptime, buffer, sizeof(buffer));
+  frame.Put(row, 11, buffer);
+  frame.Box(0, row + 1);
+}
+
+// DONE: Place the process columns for a frame this wide
+// The numbers get fixed widths, the user column grows with the terminal up
+// to 16 characters and the command takes the rest, ex.: 80 -> 30 for it
+NCursesDisplay::Columns NCursesDisplay::ColumnsFor(int width) {
+  Columns columns;
+  columns.pid = 2;
+  columns.user = columns.pid + 9;  // pid_max is at most 4194304
+  columns.cpu = columns.user + std::clamp(width / 10, 9, 17);
+  columns.ram = columns.cpu + 8;        // 100.00
+  columns.time = columns.ram + 10;      // MB
+  columns.command = columns.time + 11;  // 100:00:00
+  columns.end = std::max(columns.command, width - 1);
+  return columns;
+}
+
+// DONE: The process box, top is its first frame row
+// Every value is cut to its column, so a long user name cannot run into
+// the CPU column.
+void NCursesDisplay::DisplayProcesses(
+    std::vector<ProcessRow> const& processes, Frame& frame, int top, int n,
+    SortKey key) {
+  Columns const columns = ColumnsFor(frame.Columns());
+  frame.Box(top, top + 2 + n);
+  int row{top + 1};
+  // The column the list is ranked by is shown in reverse video
+  auto title = [&](int column, char const* name, bool sorted) {
+    frame.Put(row, column, name, COLOR_PAIR(2) | (sorted ? A_REVERSE : 0));
+  };
+  title(columns.pid, "PID", key == SortKey::kPid);
+  title(columns.user, "USER", false);
+  title(columns.cpu, "CPU[%]", key == SortKey::kCpu);
+  title(columns.ram, "RAM[MB]", key == SortKey::kRam);
+  title(columns.time, "TIME+", key == SortKey::kCpuTime);
+  title(columns.command, "COMMAND", false);
+
+  // Up to, not including, the column at end
+  auto cell = [&](int column, int end, std::string_view text) {
+    frame.Put(row, column, text.substr(0, std::max(0, end - column)));
+  };
+  char buffer[32];
+  n = std::min<int>(n, processes.size());
   for (int i = 0; i < n; ++i) {
-    mvwprintw(window, ++row, pid_column,
-              std::to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column,
-              std::to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+    ProcessRow const& process = processes[i];
+    ++row;
+    std::snprintf(buffer, sizeof(buffer), "%d", process.pid);
+    cell(columns.pid, columns.user - 1, buffer);
+    cell(columns.user, columns.cpu - 1, process.user);
+    std::snprintf(buffer, sizeof(buffer), "%.2f", process.cpu * 100);
+    cell(columns.cpu, columns.ram - 1, buffer);
+    cell(columns.ram, columns.time - 1, process.ram);
+    Format::ElapsedTime(process.uptime, buffer, sizeof(buffer));
+    cell(columns.time, columns.command - 1, buffer);
+    if (process.tgid != 0) {
+      // A thread, under the row of its process
+      cell(columns.command, columns.end, "`- ");
+      cell(columns.command + 3, columns.end, process.command);
+    } else {
+      cell(columns.command, columns.end, process.command);
+    }
   }
 }
 
-void NCursesDisplay::Display(System& system, int n) {
-  initscr();      // start ncurses
-  noecho();       // do not print input values
-  cbreak();       // terminate ncurses on ctrl + c
-  start_color();  // enable color
-
-  int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
-  WINDOW* process_window =
-      newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
-
-  while (true) {
-    init_pair(1, COLOR_BLUE, COLOR_BLACK);
-    init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    box(system_window, 0, 0);
-    box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
-    wrefresh(system_window);
-    wrefresh(process_window);
+// c: cpu, m: memory, t: cpu time, a: age, p: pid
+bool NCursesDisplay::SortKeyFor(int input, SortKey& key) {
+  switch (input) {
+    case 'c':
+      key = SortKey::kCpu;
+      return true;
+    case 'm':
+      key = SortKey::kRam;
+      return true;
+    case 't':
+      key = SortKey::kCpuTime;
+      return true;
+    case 'a':
+      key = SortKey::kAge;
+      return true;
+    case 'p':
+      key = SortKey::kPid;
+      return true;
+  }
+  return false;
+}
+
+// DONE: The monitor's own costs over the last sampling period
+// ex.: enumerate 0.31ms parse 12.10ms ... files 1003 read 250kB allocs 640
+int NCursesDisplay::StatsLine(Instrumentation::Totals const& stats,
+                              char* buffer, std::size_t size) {
+  if (size == 0) return 0;
+#if MONITOR_INSTRUMENT
+  std::size_t length{0};
+  auto append = [&](int written) {
+    if (written > 0) {
+      length = std::min(size - 1, length + written);
+    }
+  };
+  for (int phase = 0; phase < Instrumentation::kPhases; ++phase) {
+    append(std::snprintf(buffer + length, size - length, "%s %.2fms  ",
+                         Instrumentation::Name(Instrumentation::Phase(phase)),
+                         stats.phase_ns[phase] / 1e6));
+  }
+  append(std::snprintf(buffer + length, size - length,
+                       "files %ld  read %ldkB  allocs %ld", stats.files_opened,
+                       stats.bytes_read / 1024, stats.allocations));
+  return static_cast<int>(length);
+#else
+  static_cast<void>(stats);
+  int length = std::snprintf(buffer, size, "instrumentation compiled out");
+  return std::clamp<int>(length, 0, size - 1);
+#endif
+}
+
+// Rendering runs on the calling thread and never waits for a sampling pass:
+// getch blocks for at most kInputTimeout, then the newest snapshot is drawn
+// if the sampler published one since the last frame. q quits, d toggles the
+// debug row under the processes.
+// Each frame is composed in a Frame and only the cells that changed reach
+// the terminal, a resize redraws everything once.
+void NCursesDisplay::Display(SnapshotSource& source) {
+  int n = static_cast<int>(source.Rows());
+  initscr();                 // start ncurses
+  noecho();                  // do not print input values
+  cbreak();                  // terminate ncurses on ctrl + c
+  start_color();             // enable color
+  timeout(kInputTimeoutMs);  // wait this long for a key, then draw
+  init_pair(1, COLOR_BLUE, COLOR_BLACK);
+  init_pair(2, COLOR_GREEN, COLOR_BLACK);
+  init_pair(3, COLOR_GREEN, COLOR_BLACK);
+  init_pair(4, COLOR_YELLOW, COLOR_BLACK);
+  init_pair(5, COLOR_RED, COLOR_BLACK);
+  SortKey key{source.Key()};
+
+  Frame frame;
+  source.Start();
+  unsigned long drawn{0};
+  bool debug{false};
+  for (int input = ERR; input != 'q'; input = getch()) {
+    if (SortKeyFor(input, key)) {
+      source.SortBy(key);
+    } else if (input == 'd') {
+      debug = !debug;
+      drawn = 0;
+    } else if (input == KEY_RESIZE) {
+      drawn = 0;
+    }
+    auto snapshot = source.Latest();
+    if (snapshot == nullptr || snapshot->epoch == drawn) continue;
+    drawn = snapshot->epoch;
+    MONITOR_PHASE(kRender);
+    // The heat strip grows the system box once the core count is known
+    int width = getmaxx(stdscr) - 1;
+    int strip_rows = snapshot->cores.empty()
+                         ? 0
+                         : HeatStripRows(snapshot->cores.size(), width);
+    int top = kSystemRows + strip_rows;  // of the process box
+    int rows = std::min(top + 4 + n, getmaxy(stdscr));
+    if (rows != frame.Rows() || width != frame.Columns()) {
+      frame.Resize(rows, width);
+      clear();
+    }
+    frame.Clear();
+    DisplaySystem(*snapshot, frame);
+    DisplayProcesses(snapshot->processes, frame, top, n, snapshot->key);
+    if (debug) {
+      char line[512];
+      frame.Put(top + 3 + n, 2,
+                std::string_view(line, StatsLine(snapshot->stats, line,
+                                                 sizeof(line))));
+    }
+    frame.Flush(stdscr);
     refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
   }
+  source.Stop();
   endwin();
 }
@@ -0,0 +1,202 @@
+#include "options.h"
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "process.h"
+#include "snapshot.h"
+
+namespace {
+bool ParseNumber(char const* text, long& value) {
+  char* end{nullptr};
+  value = std::strtol(text, &end, 10);
+  return end != text && *end == '\0' && value >= 0;
+}
+
+bool ParseSortKey(std::string_view name, SortKey& key) {
+  if (name == "cpu") {
+    key = SortKey::kCpu;
+  } else if (name == "mem" || name == "ram") {
+    key = SortKey::kRam;
+  } else if (name == "time") {
+    key = SortKey::kCpuTime;
+  } else if (name == "age") {
+    key = SortKey::kAge;
+  } else if (name == "pid") {
+    key = SortKey::kPid;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// ex.: pid,user,cpu
+bool ParseFields(std::string_view names, unsigned& fields) {
+  fields = 0;
+  while (!names.empty()) {
+    std::size_t comma = names.find(',');
+    std::string_view name = names.substr(0, comma);
+    names.remove_prefix(comma == std::string_view::npos ? names.size()
+                                                        : comma + 1);
+    if (name == "pid") {
+      fields |= kPidField;
+    } else if (name == "user") {
+      fields |= kUserField;
+    } else if (name == "cpu") {
+      fields |= kCpuField;
+    } else if (name == "ram") {
+      fields |= kRamField;
+    } else if (name == "time") {
+      fields |= kTimeField;
+    } else if (name == "command") {
+      fields |= kCommandField;
+    } else if (name == "cores") {
+      fields |= kCoresField;
+    } else if (name == "stats") {
+      fields |= kStatsField;
+    } else {
+      return false;
+    }
+  }
+  return fields != 0;
+}
+}  // namespace
+
+// DONE: Fill the options from argv, false with a message on bad input
+bool Options::Parse(int argc, char* argv[], std::string& error) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view flag{argv[i]};
+    if (flag == "-b" || flag == "--batch") {
+      batch = true;
+      continue;
+    }
+    if (flag == "--threads") {
+      threads = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      error = "unknown or incomplete option " + std::string(flag);
+      return false;
+    }
+    char const* value = argv[++i];
+    long number{0};
+    bool valid{true};
+    if (flag == "-w" || flag == "--workers") {
+      valid = ParseNumber(value, number) && number > 0;
+      workers = number;
+    } else if (flag == "--max-backoff") {
+      valid = ParseNumber(value, number) && number > 0;
+      max_backoff = number;
+    } else if (flag == "--thread-budget") {
+      valid = ParseNumber(value, number) && number > 0;
+      thread_budget = number;
+    } else if (flag == "-d" || flag == "--interval") {
+      valid = ParseNumber(value, number) && number > 0;
+      interval = std::chrono::milliseconds(number);
+    } else if (flag == "-n" || flag == "--iterations") {
+      valid = ParseNumber(value, number);
+      iterations = number;
+    } else if (flag == "-t" || flag == "--top") {
+      valid = ParseNumber(value, number);
+      top = number;
+    } else if (flag == "-s" || flag == "--sort") {
+      valid = ParseSortKey(value, key);
+    } else if (flag == "-u" || flag == "--user") {
+      user = value;
+      valid = !user.empty();
+    } else if (flag == "-f" || flag == "--format") {
+      std::string_view name{value};
+      valid = name == "csv" || name == "json";
+      format = name == "json" ? OutputFormat::kJsonLines : OutputFormat::kCsv;
+    } else if (flag == "-o" || flag == "--output") {
+      output = value;
+    } else if (flag == "--fields") {
+      valid = ParseFields(value, fields);
+    } else if (flag == "--record") {
+      record = value;
+    } else if (flag == "--record-mb") {
+      valid = ParseNumber(value, number) && number > 0;
+      record_mb = number;
+    } else if (flag == "--serve") {
+      serve = value;
+      valid = !serve.empty();
+    } else if (flag == "--replay") {
+      replay = value;
+    } else if (flag == "--speed") {
+      char* end{nullptr};
+      speed = std::strtod(value, &end);
+      valid = end != value && *end == '\0' && speed >= 0;
+    } else if (flag == "--proc") {
+      proc = value;
+    } else if (flag == "--passwd") {
+      passwd = value;
+    } else {
+      error = "unknown option " + std::string(flag);
+      return false;
+    }
+    if (!valid) {
+      error = "invalid value " + std::string(value) + " for " +
+              std::string(flag);
+      return false;
+    }
+  }
+  if (!record.empty() && !replay.empty()) {
+    error = "--record and --replay do not mix";
+    return false;
+  }
+  if (batch && !serve.empty()) {
+    error = "--batch and --serve do not mix";
+    return false;
+  }
+  if (top == 0 && !batch && serve.empty()) {
+    error = "--top 0 needs --batch or --serve";
+    return false;
+  }
+  if (threads && (!record.empty() || !replay.empty())) {
+    error = "--threads does not mix with --record or --replay";
+    return false;
+  }
+  if (!user.empty() && !replay.empty()) {
+    error = "--user does not mix with --replay";
+    return false;
+  }
+  if (threads && top == 0) {
+    error = "--threads needs a --top limit";
+    return false;
+  }
+  if (threads) fields |= kThreadsField;
+  return true;
+}
+
+// DONE: Return the help text
+std::string Options::Usage(char const* program) {
+  return std::string("usage: ") + program +
+         " [options]\n"
+         "  -w, --workers N      threads reading /proc (default 2)\n"
+         "  -d, --interval MS    sampling period (default 1000)\n"
+         "      --max-backoff N  ticks an idle process may go unread\n"
+         "                       (default 16, 1 reads all every tick)\n"
+         "      --threads        list the busiest threads under each row\n"
+         "      --thread-budget N\n"
+         "                       thread stats read per tick (default 4096)\n"
+         "  -t, --top N          process rows, 0 keeps all (batch, serve)\n"
+         "  -s, --sort KEY       cpu, mem, time, age or pid\n"
+         "  -u, --user NAME      only this user's processes\n"
+         "  -b, --batch          print snapshots instead of drawing them\n"
+         "  -n, --iterations N   snapshots to take, 0 runs forever\n"
+         "  -f, --format FORMAT  csv or json (one object per line)\n"
+         "  -o, --output FILE    batch output file (default stdout)\n"
+         "      --fields LIST    process columns, ex.: pid,user,cpu,ram,"
+         "time,command\n"
+         "                       plus cores (per-core utilization) and\n"
+         "                       stats (the monitor's own cost per tick)\n"
+         "      --serve ADDR     export Prometheus metrics over HTTP on\n"
+         "                       127.0.0.1:ADDR, or a unix socket path\n"
+         "      --record FILE    append every sample to a ring file\n"
+         "      --record-mb N    ring file size limit (default 64)\n"
+         "      --replay FILE    play a recording instead of sampling\n"
+         "      --speed X        replay speed, 0 as fast as possible\n"
+         "      --proc DIR       proc tree to read (default /proc)\n"
+         "      --passwd FILE    user names (default /etc/passwd)\n";
+}
@@ -0,0 +1,109 @@
+#include "pid_directory.h"
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+
+namespace {
+// The record getdents64(2) fills, glibc only declares it for _GNU_SOURCE
+struct Dirent64 {
+  std::uint64_t d_ino;
+  std::int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+// ex.: "4242" -> 4242, -1 for "self", "4242x" or anything out of range
+int ParsePid(char const* name) {
+  if (*name < '1' || *name > '9') return -1;
+  long pid{0};
+  for (; *name != '\0'; ++name) {
+    if (*name < '0' || *name > '9' || pid > 0x7fffffff / 10) return -1;
+    pid = pid * 10 + (*name - '0');
+  }
+  return pid > 0x7fffffff ? -1 : static_cast<int>(pid);
+}
+}  // namespace
+
+PidDirectory::PidDirectory(std::string path, std::size_t capacity)
+    : path_(std::move(path)), buffer_(capacity) {}
+
+PidDirectory::~PidDirectory() { Close(); }
+
+// DONE: List the pids currently in the directory
+bool PidDirectory::Read(std::vector<int>& pids, bool sorted) {
+  pids.clear();
+  if (fd_ < 0 && !Open()) {
+    return false;
+  }
+  if (!Fill(pids)) {
+    // Stale descriptor, ex.: procfs remounted under us
+    Close();
+    pids.clear();
+    if (!Open() || !Fill(pids)) {
+      Close();
+      pids.clear();
+      return false;
+    }
+  }
+  if (sorted && !std::is_sorted(pids.begin(), pids.end())) {
+    std::sort(pids.begin(), pids.end());
+  }
+  return true;
+}
+
+// One getdents64 call returns as many whole records as fit the buffer, an
+// empty one marks the end of the directory
+bool PidDirectory::Fill(std::vector<int>& pids) {
+  if (::lseek(fd_, 0, SEEK_SET) < 0) {
+    return false;
+  }
+  while (true) {
+    long count = ::syscall(SYS_getdents64, fd_, buffer_.data(), buffer_.size());
+    if (count < 0) {
+      return false;
+    }
+    if (count == 0) {
+      return true;
+    }
+    MONITOR_COUNT_READ(count);
+    for (long offset = 0; offset < count;) {
+      char const* record = buffer_.data() + offset;
+      unsigned short length;
+      std::memcpy(&length, record + offsetof(Dirent64, d_reclen),
+                  sizeof(length));
+      int pid = ParsePid(record + offsetof(Dirent64, d_name));
+      if (pid > 0) {
+        pids.push_back(pid);
+      }
+      offset += length;
+    }
+  }
+}
+
+bool PidDirectory::Open() {
+  fd_ = ::open(path_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd_ < 0) {
+    return false;
+  }
+  MONITOR_COUNT_OPEN();
+  return true;
+}
+
+void PidDirectory::Close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
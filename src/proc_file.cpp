@@ -0,0 +1,67 @@
+#include "proc_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "instrumentation.h"
+
+ProcFile::ProcFile(std::string path, std::size_t capacity)
+    : path_(std::move(path)), buffer_(capacity + 1) {}
+
+ProcFile::~ProcFile() { Close(); }
+
+// DONE: Return the current contents of the file
+std::string_view ProcFile::Read() {
+  if (fd_ < 0 && !Open()) {
+    return {};
+  }
+  long size = Fill();
+  if (size < 0) {
+    // Stale descriptor, ex.: procfs remounted under us
+    Close();
+    if (!Open() || (size = Fill()) < 0) {
+      Close();
+      return {};
+    }
+  }
+  return {buffer_.data(), static_cast<std::size_t>(size)};
+}
+
+// procfs generates the file on every read from offset 0; a short read
+// means the whole file fit, a full one means the buffer has to grow.
+long ProcFile::Fill() {
+  while (true) {
+    std::size_t room = buffer_.size() - 1;
+    ssize_t count = ::pread(fd_, buffer_.data(), room, 0);
+    if (count < 0) {
+      return -1;
+    }
+    MONITOR_COUNT_READ(count);
+    if (static_cast<std::size_t>(count) < room) {
+      buffer_[count] = '\0';
+      return static_cast<long>(count);
+    }
+    buffer_.resize(buffer_.size() * 2);
+  }
+}
+
+bool ProcFile::Open() {
+  fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    return false;
+  }
+  MONITOR_COUNT_OPEN();
+  return true;
+}
+
+void ProcFile::Close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
@@ -2,15 +2,14 @@
 
 #include <unistd.h>
 
-#include <cctype>
-#include <sstream>
+#include <cstring>
+#include <memory>
 #include <string>
-#include <vector>
 
 #include "linux_parser.h"
-#include "process.h"
 
-Process::Process(int pid) : pid_(pid) {}
+Process::Process(int pid)
+    : pid_(pid), attributes_(std::make_shared<Attributes>()) {}
 
 // DONE: Return this process's ID
 int Process::Pid() const { return pid_; }
@@ -19,32 +18,120 @@ int Process::Pid() const { return pid_; }
 float Process::CpuUtilization() const { return cpu_; }
 
 // DONE: Set this process's CPU utilization
-void Process::CpuUtilization(long active_ticks, long system_ticks) {
-  long duration_active{active_ticks - prev_active_ticks_};
-  long duration{system_ticks - prev_system_ticks_};
-  cpu_ = static_cast<float>(duration_active) / duration;
+// boot_ns is when active_ticks was read, see LinuxParser::BootTime
+void Process::CpuUtilization(long active_ticks, long long boot_ns) {
+  if (boot_ns > prev_boot_ns_) {
+    cpu_ = LinuxParser::CpuShare(active_ticks - prev_active_ticks_,
+                                 boot_ns - prev_boot_ns_);
+  }
   prev_active_ticks_ = active_ticks;
-  prev_system_ticks_ = system_ticks;
+  prev_boot_ns_ = boot_ns;
+}
+
+// DONE: Take this tick's values from a single /proc/[pid]/stat sample
+void Process::Update(LinuxParser::PidStat const& stat, long long boot_ns) {
+  // exec(2) renames the process, its command line is stale now
+  if (std::strcmp(stat_.comm, stat.comm) != 0 && attributes_->command_loaded) {
+    attributes_->command_loaded = false;
+  }
+  stat_ = stat;
+  CpuUtilization(stat_.ActiveJiffies(), boot_ns);
 }
 
+// DONE: Return the last /proc/[pid]/stat sample
+LinuxParser::PidStat const& Process::Stat() const { return stat_; }
+
 // DONE: Return the command that generated this process
-std::string Process::Command() const { return LinuxParser::Command(Pid()); }
+// Kernel threads and zombies have no command line, show [comm] like ps
+std::string Process::Command() const {
+  Attributes& attributes = Cached();
+  if (!attributes.command_loaded) {
+    attributes.command = LinuxParser::Command(Pid());
+    attributes.command_loaded = true;
+  }
+  if (attributes.command.empty()) {
+    return std::string("[") + stat_.comm + "]";
+  }
+  return attributes.command;
+}
 
 // DONE: Return this process's memory utilization
-std::string Process::Ram() const { return LinuxParser::Ram(Pid()); }
+// Resident MB from the stat sample, the same value a RAM sort ranks by
+std::string Process::Ram() const { return std::to_string(Rss() / 1024); }
 
 // DONE: Return the user (name) that generated this process
-std::string Process::User() const { return LinuxParser::User(Pid()); }
+std::string Process::User() const {
+  Uid();
+  return Cached().user;
+}
+
+// DONE: Return the real user ID, read once per process
+int Process::Uid() const {
+  Attributes& attributes = Cached();
+  if (!attributes.user_loaded) {
+    LinuxParser::PidStatus status;
+    LinuxParser::Status(Pid(), status);
+    Resolve(status);
+  }
+  return attributes.uid;
+}
+
+// Take the user from a status read, unless an earlier one did
+// A failed read (exited, hidepid) leaves it unread, the next use retries.
+void Process::Resolve(LinuxParser::PidStatus const& status) const {
+  Attributes& attributes = Cached();
+  if (attributes.user_loaded || status.uid < 0) return;
+  attributes.uid = static_cast<int>(status.uid);
+  attributes.user = LinuxParser::UserName(attributes.uid);
+  attributes.user_loaded = true;
+}
+
+Process::Attributes& Process::Cached() const { return *attributes_; }
 
 // DONE: Return the age of this process (in seconds)
-long int Process::UpTime() const { return LinuxParser::UpTime(Pid()); }
+long int Process::UpTime() const {
+  return stat_.utime / LinuxParser::TicksPerSecond();
+}
+
+// DONE: Return the resident set size in kB
+long Process::Rss() const {
+  static long const page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  return stat_.rss * page_kb;
+}
+
+// DONE: Return the user and kernel jiffies this process has used
+long Process::CpuTime() const { return stat_.utime + stat_.stime; }
+
+// DONE: Order two processes by key, > 0 when this one ranks first
+// Ties fall back to the lower pid so equal rows keep their place
+int Process::Compare(Process const& other, SortKey key) const {
+  auto order = [](auto a, auto b) { return (a > b) - (a < b); };
+  int result{0};
+  switch (key) {
+    case SortKey::kCpu:
+      result = order(cpu_, other.cpu_);
+      break;
+    case SortKey::kRam:
+      result = order(stat_.rss, other.stat_.rss);
+      break;
+    case SortKey::kCpuTime:
+      result = order(CpuTime(), other.CpuTime());
+      break;
+    case SortKey::kAge:
+      result = order(other.stat_.starttime, stat_.starttime);
+      break;
+    case SortKey::kPid:
+      break;
+  }
+  return result != 0 ? result : order(other.pid_, pid_);
+}
 
 // DONE: Overload the "less than" comparison operator for Process objects
 bool Process::operator<(Process const& other) const {
-  return CpuUtilization() < other.CpuUtilization();
+  return Compare(other, SortKey::kCpu) < 0;
 }
 
 // DONE: Overload the "greater than" comparison operator for Process objects
 bool Process::operator>(Process const& other) const {
-  return CpuUtilization() > other.CpuUtilization();
+  return Compare(other, SortKey::kCpu) > 0;
 }
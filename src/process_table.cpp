@@ -0,0 +1,401 @@
+#include "process_table.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "field_sources.h"
+#include "linux_parser.h"
+#include "process.h"
+#include "snapshot.h"
+#include "string_pool.h"
+#include "worker_pool.h"
+
+namespace {
+// Move the last entry of every column into slot, then drop the last
+template <typename... Columns>
+void MoveLast(std::size_t slot, Columns&... columns) {
+  ((columns[slot] = std::move(columns.back()), columns.pop_back()), ...);
+}
+}  // namespace
+
+// DONE: Diff this tick's pids against the table and resample the due entries
+// A known pid that is not due yet only counts as seen, its last sample
+// stands. The next one measures its CPU over the whole gap. Unless
+// activity says it may have changed, see Allocated() and Unaccounted().
+// The /proc reads are sharded across the pool. Each worker writes only the
+// samples at its own indices, so they need no lock and no merge copy; the
+// table itself is then updated on the calling thread.
+void ProcessTable::Update(std::vector<int> const& pids, long long boot_ns,
+                          Activity const& activity, WorkerPool& pool) {
+  ++generation_;
+  added_ = 0;
+  reaped_ = 0;
+  due_.clear();
+  skipped_.clear();
+  for (int pid : pids) {
+    auto slot = slots_.find(pid);
+    if (slot != slots_.end() && backoff_[slot->second].due > generation_ &&
+        !Allocated(pid, activity)) {
+      seen_[slot->second] = generation_;
+      skipped_.push_back(pid);
+    } else {
+      due_.push_back(pid);
+    }
+  }
+
+  long accounted = ReadDue(0, boot_ns, pool);
+  if (!skipped_.empty() && Unaccounted(activity, boot_ns, accounted)) {
+    std::size_t first = due_.size();
+    due_.insert(due_.end(), skipped_.begin(), skipped_.end());
+    ReadDue(first, boot_ns, pool);
+  }
+  activity_ = activity;
+  boot_ns_ = boot_ns;
+
+  for (Slot slot = 0; slot < pids_.size();) {
+    if (seen_[slot] == generation_) {
+      ++slot;
+    } else {
+      Reap(slot);
+    }
+  }
+}
+
+// Read and apply the stat files of due_ from first on
+// Returns the CPU ticks they were charged since the last update.
+long ProcessTable::ReadDue(std::size_t first, long long boot_ns,
+                           WorkerPool& pool) {
+  samples_.resize(due_.size());
+  pool.Run(due_.size() - first, kChunk,
+           [&](std::size_t, std::size_t begin, std::size_t end) {
+             for (std::size_t i = first + begin; i < first + end; ++i) {
+               samples_[i].valid = LinuxParser::Stat(due_[i], samples_[i].stat);
+             }
+           });
+
+  // Processes started since the last update are charged all of their time
+  long long since = boot_ns_ * LinuxParser::TicksPerSecond() / 1'000'000'000;
+  long accounted{0};
+  for (std::size_t i = first; i < due_.size(); ++i) {
+    // Exited between enumeration and sampling, reaped below
+    if (!samples_[i].valid) continue;
+    int pid = due_[i];
+    LinuxParser::PidStat const& stat = samples_[i].stat;
+    auto found = slots_.find(pid);
+    Slot slot;
+    if (found == slots_.end()) {
+      slot = static_cast<Slot>(pids_.size());
+      Add(pid);
+      ++added_;
+    } else {
+      slot = found->second;
+      if (starttimes_[slot] != stat.starttime) {
+        // Pid reused by a new process
+        Reset(slot);
+        ++reaped_;
+        ++added_;
+      }
+    }
+    long cpu_time = stat.utime + stat.stime;
+    if (cold_[slot].boot_ns != 0) {
+      accounted += cpu_time - cpu_times_[slot];
+    } else if (stat.starttime >= since) {
+      accounted += cpu_time;
+    }
+    bool active = stat.state == 'R' ||
+                  stat.ActiveJiffies() != cold_[slot].active_ticks;
+    Apply(slot, stat, boot_ns);
+    seen_[slot] = generation_;
+    Schedule(slot, active);
+  }
+  return accounted;
+}
+
+// Whether the kernel handed out pid since the last update
+// Pids are handed out in increasing order up to pid_max, then from the
+// bottom again, so a known pid in that range may be a new process.
+bool ProcessTable::Allocated(int pid, Activity const& activity) const {
+  int from = activity_.last_pid;
+  int to = activity.last_pid;
+  if (from < 0 || to < 0) return false;
+  if (from <= to) return pid > from && pid <= to;
+  return pid > from || pid <= to;
+}
+
+// Whether the machine spent noticeably more CPU time in processes than the
+// samples were charged, ex.: a skipped process woke up
+// A process that exited in between also leaves its last ticks unaccounted.
+// The slack is a tenth of one CPU over the interval, at least two ticks for
+// the jitter between reading /proc/stat and the stat files.
+bool ProcessTable::Unaccounted(Activity const& activity, long long boot_ns,
+                               long accounted) const {
+  if (activity_.busy_ticks < 0 || activity.busy_ticks < 0) return false;
+  long elapsed = static_cast<long>((boot_ns - boot_ns_) *
+                                   LinuxParser::TicksPerSecond() /
+                                   1'000'000'000);
+  long slack = std::max(elapsed / 10, 2L);
+  return activity.busy_ticks - activity_.busy_ticks - accounted > slack;
+}
+
+// Take one /proc/[pid]/stat sample, the CPU share is the same delta as
+// Process::CpuUtilization computes
+void ProcessTable::Apply(Slot slot, LinuxParser::PidStat const& stat,
+                         long long boot_ns) {
+  Cold& cold = cold_[slot];
+  // exec(2) renames the process, its command line is stale now
+  if (strings_.View(cold.comm) != stat.comm) {
+    strings_.Release(cold.comm);
+    cold.comm = strings_.Intern(stat.comm);
+    if (cold.command != kUnread) {
+      strings_.Release(cold.command);
+      cold.command = kUnread;
+    }
+  }
+  long active_ticks = stat.ActiveJiffies();
+  if (boot_ns > cold.boot_ns) {
+    cpu_[slot] = LinuxParser::CpuShare(active_ticks - cold.active_ticks,
+                                       boot_ns - cold.boot_ns);
+  }
+  cold.active_ticks = active_ticks;
+  cold.boot_ns = boot_ns;
+  cold.utime = stat.utime;
+  rss_[slot] = stat.rss;
+  cpu_times_[slot] = stat.utime + stat.stime;
+  starttimes_[slot] = stat.starttime;
+}
+
+// DONE: Pick the next generation that samples a slot
+// Idle samples double the gap up to the maximum, any CPU time resets it
+void ProcessTable::Schedule(Slot slot, bool active) {
+  Backoff& backoff = backoff_[slot];
+  backoff.ticks = active ? 1 : std::min(backoff.ticks * 2, max_backoff_);
+  backoff.due = generation_ + backoff.ticks;
+}
+
+void ProcessTable::Add(int pid) {
+  slots_.emplace(pid, static_cast<Slot>(pids_.size()));
+  pids_.push_back(pid);
+  cpu_.push_back(0);
+  rss_.push_back(0);
+  cpu_times_.push_back(0);
+  starttimes_.push_back(0);
+  cold_.emplace_back();
+  seen_.push_back(0);
+  backoff_.emplace_back();
+}
+
+// DONE: Start a slot over for a new process under the same pid
+void ProcessTable::Reset(Slot slot) {
+  Cold& cold = cold_[slot];
+  strings_.Release(cold.comm);
+  if (cold.command != kUnread) strings_.Release(cold.command);
+  if (cold.user != kUnread) strings_.Release(cold.user);
+  cold = Cold{};
+  cpu_[slot] = 0;
+  backoff_[slot] = Backoff{};
+}
+
+// DONE: Remove an exited process, the last entry takes over its slot
+void ProcessTable::Reap(Slot slot) {
+  Reset(slot);
+  slots_.erase(pids_[slot]);
+  MoveLast(slot, pids_, cpu_, rss_, cpu_times_, starttimes_, cold_, seen_,
+           backoff_);
+  if (slot < pids_.size()) {
+    slots_[pids_[slot]] = slot;
+  }
+  ++reaped_;
+}
+
+// DONE: Write the slots of the n best ranked processes into top, best first
+// Bounded heap over slots: O(P log n) instead of sorting all P processes,
+// and each comparison reads the key column and the pids only.
+void ProcessTable::Top(std::size_t n, SortKey key,
+                       std::vector<Slot>& top) const {
+  top.clear();
+  if (n == 0) {
+    return;
+  }
+  auto ranks_first = [this, key](Slot a, Slot b) {
+    return Compare(a, b, key) > 0;
+  };
+  for (Slot slot = 0; slot < pids_.size(); ++slot) {
+    // Unresolved users are kUnread, a filter leaves them out
+    if (filter_ != kUnread && cold_[slot].user != filter_) continue;
+    if (top.size() < n) {
+      top.push_back(slot);
+      std::push_heap(top.begin(), top.end(), ranks_first);
+    } else if (ranks_first(slot, top.front())) {
+      std::pop_heap(top.begin(), top.end(), ranks_first);
+      top.back() = slot;
+      std::push_heap(top.begin(), top.end(), ranks_first);
+    }
+  }
+  std::sort_heap(top.begin(), top.end(), ranks_first);
+}
+
+// Same order as Process::Compare, > 0 when a ranks first
+int ProcessTable::Compare(Slot a, Slot b, SortKey key) const {
+  auto order = [](auto x, auto y) { return (x > y) - (x < y); };
+  int result{0};
+  switch (key) {
+    case SortKey::kCpu:
+      result = order(cpu_[a], cpu_[b]);
+      break;
+    case SortKey::kRam:
+      result = order(rss_[a], rss_[b]);
+      break;
+    case SortKey::kCpuTime:
+      result = order(cpu_times_[a], cpu_times_[b]);
+      break;
+    case SortKey::kAge:
+      result = order(starttimes_[b], starttimes_[a]);
+      break;
+    case SortKey::kPid:
+      break;
+  }
+  return result != 0 ? result : order(pids_[b], pids_[a]);
+}
+
+// DONE: Sample these slots on the next update, ex.: the rows on screen
+void ProcessTable::Hot(std::vector<Slot> const& slots) {
+  for (Slot slot : slots) {
+    backoff_[slot] = Backoff{};
+  }
+}
+
+// DONE: Set how many ticks an idle process may go unsampled
+void ProcessTable::MaxBackoff(unsigned ticks) {
+  max_backoff_ = std::max(ticks, 1u);
+}
+
+// DONE: Return how many processes the table holds
+std::size_t ProcessTable::Size() const { return pids_.size(); }
+
+// DONE: Return how many processes appeared during the last update
+int ProcessTable::Added() const { return added_; }
+
+// DONE: Return how many processes exited during the last update
+int ProcessTable::Reaped() const { return reaped_; }
+
+// DONE: Return how many /proc/[pid]/stat files the last update read
+int ProcessTable::Sampled() const { return static_cast<int>(due_.size()); }
+
+int ProcessTable::Pid(Slot slot) const { return pids_[slot]; }
+
+long long ProcessTable::StartTime(Slot slot) const {
+  return starttimes_[slot];
+}
+
+float ProcessTable::CpuUtilization(Slot slot) const { return cpu_[slot]; }
+
+// DONE: Return the age of a process (in seconds), as Process::UpTime
+long ProcessTable::UpTime(Slot slot) const {
+  return cold_[slot].utime / LinuxParser::TicksPerSecond();
+}
+
+// DONE: Return the resident set size in kB
+long ProcessTable::Rss(Slot slot) const {
+  static long const page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  return rss_[slot] * page_kb;
+}
+
+// DONE: Return the user and kernel jiffies a process has used
+long ProcessTable::CpuTime(Slot slot) const { return cpu_times_[slot]; }
+
+// DONE: Return the user (name) that started a process, read once
+// Empty while the status file could not be read
+std::string_view ProcessTable::User(Slot slot) {
+  Uid(slot);
+  return Name(cold_[slot].user);
+}
+
+// DONE: Return the real user ID, read once per process, -1 until read
+int ProcessTable::Uid(Slot slot) {
+  if (cold_[slot].user == kUnread) {
+    LinuxParser::PidStatus status;
+    LinuxParser::Status(pids_[slot], status);
+    Resolve(slot, status);
+  }
+  return cold_[slot].uid;
+}
+
+// Take the user from a status read, unless an earlier one did
+// A failed read (exited, hidepid) leaves it unread, the next use retries.
+void ProcessTable::Resolve(Slot slot, LinuxParser::PidStatus const& status) {
+  Cold& cold = cold_[slot];
+  if (cold.user != kUnread || status.uid < 0) return;
+  cold.uid = static_cast<int>(status.uid);
+  cold.user = strings_.Intern(LinuxParser::UserName(cold.uid));
+}
+
+// DONE: Return the command that started a process, read once
+// Kernel threads and zombies have no command line, show [comm] like ps
+std::string_view ProcessTable::Command(Slot slot) {
+  Cold& cold = cold_[slot];
+  if (cold.command == kUnread) {
+    std::string command = LinuxParser::Command(pids_[slot]);
+    if (command.empty()) {
+      command.append("[").append(strings_.View(cold.comm)).append("]");
+    }
+    cold.command = strings_.Intern(command);
+  }
+  return strings_.View(cold.command);
+}
+
+// DONE: Rank only the processes of this user, empty ranks all again
+void ProcessTable::Filter(std::string_view user) {
+  if (filter_ != kUnread) strings_.Release(filter_);
+  filter_ = user.empty() ? kUnread : strings_.Intern(user);
+}
+
+// DONE: Load what ranking by key and the filter need on every process
+// The keys rank by stat columns, so only a filter costs anything: one
+// status read per process, once in its lifetime.
+void ProcessTable::Prepare(SortKey key) {
+  unsigned sources = FieldSources::Sources(key);
+  if (filter_ != kUnread) sources |= FieldSources::Sources(kUserField);
+  if ((sources & FieldSources::kStatus) == 0) return;
+  for (Slot slot = 0; slot < pids_.size(); ++slot) {
+    Uid(slot);
+  }
+}
+
+// DONE: Fill a shown row with the selected fields
+// Each source the fields need is read once, see FieldSources. kStat is
+// this tick's sample and the kProcess fields a slot holds cost nothing, so
+// once user and command are loaded a row costs no file read.
+void ProcessTable::Load(Slot slot, unsigned fields, ProcessRow& row) {
+  unsigned sources = FieldSources::Sources(fields, Loaded(slot));
+  if (sources & FieldSources::kStatus) Uid(slot);
+  if (sources & FieldSources::kCmdline) Command(slot);
+  row.pid = pids_[slot];
+  row.cpu = cpu_[slot];
+  row.uptime = UpTime(slot);
+  if (fields & kRamField) {
+    row.rss = Rss(slot);
+    row.ram = std::to_string(row.rss / 1024);
+  }
+  // Loaded above, a failed status read is not retried for the same row
+  if (fields & kUserField) row.user = Name(cold_[slot].user);
+  if (fields & kCommandField) row.command = Name(cold_[slot].command);
+}
+
+// The kProcess fields a slot holds already
+unsigned ProcessTable::Loaded(Slot slot) const {
+  unsigned loaded{kPidField};
+  if (cold_[slot].user != kUnread) loaded |= kUserField;
+  if (cold_[slot].command != kUnread) loaded |= kCommandField;
+  return loaded;
+}
+
+// An interned string, empty while unread
+std::string_view ProcessTable::Name(StringPool::Id id) const {
+  return id == kUnread ? std::string_view{} : strings_.View(id);
+}
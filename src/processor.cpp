@@ -1,19 +1,92 @@
 #include "processor.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
 #include "linux_parser.h"
 
-// DONE: Return the aggregate CPU utilization
-float Processor::Utilization() {
-  float utilization{0};
-  long active_ticks = LinuxParser::ActiveJiffies();
-  long idle_ticks = LinuxParser::IdleJiffies();
+// DONE: Feed the aggregate cpu row of the current /proc/stat snapshot
+void Processor::Update(LinuxParser::CpuTimes const& times) {
+  long active_ticks = times.Active();
+  long idle_ticks = times.Idle();
   long duration_active{active_ticks - prev_active_ticks_};
   long duration_idle{idle_ticks - prev_idle_ticks_};
   long duration{duration_active + duration_idle};
-  utilization = static_cast<float>(duration_active) / duration;
+  if (duration > 0) {
+    // Counters can step back, ex.: iowait, keep the share in [0, 1]
+    utilization_ = std::clamp(static_cast<float>(duration_active) / duration,
+                              0.0f, 1.0f);
+  }
 
   // Store for next
   prev_active_ticks_ = active_ticks;
   prev_idle_ticks_ = idle_ticks;
-  return utilization;
 }
+
+// DONE: Feed the cpuN rows, every core in one pass per column
+// The loops only add, subtract and select over contiguous arrays, so the
+// compiler vectorizes them.
+void Processor::Update(LinuxParser::CoreTimes const& cores) {
+  std::size_t const count = cores.count;
+  bool const restart = prev_core_active_ticks_.size() != count;
+  if (restart) {
+    // First update or a CPU went on/offline, this reading becomes the base
+    // and every core reads 0 until the next one
+    prev_core_active_ticks_.resize(count);
+    prev_core_idle_ticks_.resize(count);
+    active_ticks_.resize(count);
+    idle_ticks_.resize(count);
+    cores_.assign(count, 0);
+  }
+  long* active = active_ticks_.data();
+  long* idle = idle_ticks_.data();
+  std::fill(active, active + count, 0);
+  for (int state : {LinuxParser::kUser_, LinuxParser::kNice_,
+                    LinuxParser::kSystem_, LinuxParser::kIRQ_,
+                    LinuxParser::kSoftIRQ_, LinuxParser::kSteal_,
+                    LinuxParser::kGuest_, LinuxParser::kGuestNice_}) {
+    long const* column = cores.states[state].data();
+    for (std::size_t i = 0; i < count; ++i) {
+      active[i] += column[i];
+    }
+  }
+  long const* idle_column = cores.states[LinuxParser::kIdle_].data();
+  long const* iowait_column = cores.states[LinuxParser::kIOwait_].data();
+  for (std::size_t i = 0; i < count; ++i) {
+    idle[i] = idle_column[i] + iowait_column[i];
+  }
+  if (restart) {
+    prev_core_active_ticks_ = active_ticks_;
+    prev_core_idle_ticks_ = idle_ticks_;
+  }
+
+  long const* prev_active = prev_core_active_ticks_.data();
+  long const* prev_idle = prev_core_idle_ticks_.data();
+  float* utilization = cores_.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    // Both readings are from this boot and at most one period apart, never
+    // counts since boot, so the deltas fit in an int. int -> float converts
+    // four lanes at a time where long -> float has no packed instruction.
+    int duration_active = static_cast<int>(active[i] - prev_active[i]);
+    int duration = duration_active + static_cast<int>(idle[i] - prev_idle[i]);
+    // Always divide, a core that saw no jiffies gets 0 / 1. Branching
+    // around the division or keeping the old value keeps the loop scalar.
+    // A counter that stepped back, ex.: iowait, is clamped to [0, 1] with
+    // packed min/max.
+    utilization[i] = std::clamp(static_cast<float>(duration_active) /
+                                    static_cast<float>(duration > 0 ? duration
+                                                                    : 1),
+                                0.0f, 1.0f);
+  }
+
+  // Store for next
+  active_ticks_.swap(prev_core_active_ticks_);
+  idle_ticks_.swap(prev_core_idle_ticks_);
+}
+
+// DONE: Return the aggregate CPU utilization
+float Processor::Utilization() const { return utilization_; }
+
+// DONE: Return the utilization of each core, in cpuN order
+std::vector<float> const& Processor::Cores() const { return cores_; }
@@ -0,0 +1,39 @@
+#include "ranking.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "process.h"
+
+// DONE: Copy the n best ranked processes into top, best first
+// Bounded heap over pointers: O(P log n) instead of sorting all P processes.
+// The heap front is the weakest of the current top n, so a process only
+// enters when it outranks it.
+void Ranking::Top(std::vector<Process> const& processes, std::size_t n,
+                  SortKey key, std::vector<Process>& top) {
+  thread_local std::vector<Process const*> heap;
+  heap.clear();
+  top.clear();
+  if (n == 0) {
+    return;
+  }
+  auto ranks_first = [key](Process const* a, Process const* b) {
+    return a->Compare(*b, key) > 0;
+  };
+  for (auto const& process : processes) {
+    if (heap.size() < n) {
+      heap.push_back(&process);
+      std::push_heap(heap.begin(), heap.end(), ranks_first);
+    } else if (ranks_first(&process, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), ranks_first);
+      heap.back() = &process;
+      std::push_heap(heap.begin(), heap.end(), ranks_first);
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), ranks_first);
+  for (auto const* process : heap) {
+    top.push_back(*process);
+  }
+}
+
@@ -0,0 +1,157 @@
+#include "recorder.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "recording.h"
+#include "snapshot.h"
+
+namespace {
+// Truncating copy that always leaves a terminated field
+template <std::size_t N>
+void CopyField(char (&field)[N], std::string const& value) {
+  std::size_t length = std::min(value.size(), N - 1);
+  std::memcpy(field, value.data(), length);
+  std::memset(field + length, 0, N - length);
+}
+}  // namespace
+
+Recorder::Recorder(std::string path, std::size_t max_bytes, std::size_t rows)
+    : path_(std::move(path)),
+      max_bytes_(max_bytes),
+      rows_(static_cast<std::uint32_t>(
+          std::clamp<std::size_t>(rows, 1, Recording::kMaxRows))) {}
+
+Recorder::~Recorder() {
+  if (map_ != nullptr) {
+    ::munmap(map_, map_size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+// DONE: Map the ring file, false with a message when it cannot be used
+bool Recorder::Open(std::string& error) {
+  std::size_t record_size = Recording::RecordSize(rows_);
+  std::size_t capacity =
+      max_bytes_ > sizeof(Recording::Header)
+          ? (max_bytes_ - sizeof(Recording::Header)) / record_size
+          : 0;
+  if (capacity == 0) {
+    error = path_ + ": size limit too small for one record";
+    return false;
+  }
+  fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  map_size_ = sizeof(Recording::Header) + capacity * record_size;
+  struct stat info;
+  bool resume = ::fstat(fd_, &info) == 0 &&
+                static_cast<std::size_t>(info.st_size) == map_size_;
+  if (!resume && ::ftruncate(fd_, 0) != 0) {
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  if (::ftruncate(fd_, map_size_) != 0) {
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  map_ = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  header_ = static_cast<Recording::Header*>(map_);
+  resume = resume &&
+           std::memcmp(header_->magic, Recording::kMagic,
+                       sizeof(Recording::kMagic)) == 0 &&
+           header_->version == Recording::kVersion &&
+           header_->record_size == record_size &&
+           header_->rows_per_record == rows_ && header_->capacity == capacity;
+  if (!resume) {
+    std::memset(header_, 0, sizeof(Recording::Header));
+    std::memcpy(header_->magic, Recording::kMagic, sizeof(Recording::kMagic));
+    header_->version = Recording::kVersion;
+    header_->record_size = static_cast<std::uint32_t>(record_size);
+    header_->rows_per_record = rows_;
+    header_->capacity = static_cast<std::uint32_t>(capacity);
+  }
+  return true;
+}
+
+// DONE: Encode snapshot into the next slot of the ring
+void Recorder::Append(Snapshot const& snapshot) {
+  if (header_ == nullptr) {
+    return;
+  }
+  Recording::Header& header = *header_;
+  Recording::Record* record = RecordAt(header.written % header.capacity);
+  if (header.written == 0) {
+    header.base_time_ms = header.last_time_ms = snapshot.time_ms;
+    header.base_uptime = header.last_uptime = snapshot.uptime;
+    header.base_total_processes = header.last_total_processes =
+        snapshot.total_processes;
+  } else if (header.written >= header.capacity) {
+    // The oldest record goes away, its deltas move into the base
+    header.base_time_ms += record->time_delta_ms;
+    header.base_uptime += record->uptime_delta;
+    header.base_total_processes += record->total_processes_delta;
+  }
+  CopyField(header.operating_system, snapshot.operating_system);
+  CopyField(header.kernel, snapshot.kernel);
+
+  // The wall clock may step back, ex.: an NTP correction. Such a record
+  // keeps the time of the one before, the following deltas are measured
+  // from the new clock again.
+  record->time_delta_ms = static_cast<std::uint32_t>(std::clamp<long long>(
+      snapshot.time_ms - header.last_time_ms, 0,
+      std::numeric_limits<std::uint32_t>::max()));
+  record->uptime_delta =
+      static_cast<std::int32_t>(snapshot.uptime - header.last_uptime);
+  record->total_processes_delta = static_cast<std::int32_t>(
+      snapshot.total_processes - header.last_total_processes);
+  record->running_processes = snapshot.running_processes;
+  record->cpu = snapshot.cpu;
+  record->memory = snapshot.memory;
+  record->key = static_cast<std::uint16_t>(snapshot.key);
+  record->rows = static_cast<std::uint16_t>(
+      std::min<std::size_t>(snapshot.processes.size(), rows_));
+  auto* rows = reinterpret_cast<Recording::Row*>(record + 1);
+  for (std::size_t i = 0; i < record->rows; ++i) {
+    ProcessRow const& from = snapshot.processes[i];
+    Recording::Row& to = rows[i];
+    to.pid = from.pid;
+    to.cpu = from.cpu;
+    to.ram_mb = std::atoi(from.ram.c_str());
+    to.time = static_cast<std::int32_t>(from.uptime);
+    CopyField(to.user, from.user);
+    CopyField(to.command, from.command);
+  }
+  header.last_time_ms = snapshot.time_ms;
+  header.last_uptime = snapshot.uptime;
+  header.last_total_processes = snapshot.total_processes;
+  // A reader of the file never sees the count cover a half written record
+  std::atomic_thread_fence(std::memory_order_release);
+  ++header.written;
+}
+
+Recording::Record* Recorder::RecordAt(std::size_t slot) {
+  char* records = static_cast<char*>(map_) + sizeof(Recording::Header);
+  return reinterpret_cast<Recording::Record*>(records +
+                                              slot * header_->record_size);
+}
@@ -0,0 +1,225 @@
+#include "replayer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "process.h"
+#include "recording.h"
+#include "snapshot.h"
+
+Replayer::Replayer(std::string path, double speed)
+    : path_(std::move(path)), speed_(speed) {}
+
+Replayer::~Replayer() {
+  Stop();
+  if (map_ != nullptr) {
+    ::munmap(map_, map_size_);
+  }
+}
+
+// DONE: Map a recording read-only, false with a message when it is not one
+bool Replayer::Load(std::string& error) {
+  int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(Recording::Header)) {
+    ::close(fd);
+    error = path_ + ": not a recording";
+    return false;
+  }
+  map_size_ = info.st_size;
+  map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    error = path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  header_ = static_cast<Recording::Header const*>(map_);
+  if (std::memcmp(header_->magic, Recording::kMagic,
+                  sizeof(Recording::kMagic)) != 0 ||
+      header_->version != Recording::kVersion ||
+      header_->rows_per_record > Recording::kMaxRows ||
+      header_->record_size !=
+          Recording::RecordSize(header_->rows_per_record) ||
+      header_->capacity == 0) {
+    header_ = nullptr;
+    error = path_ + ": not a recording or a different version";
+    return false;
+  }
+  // Every slot of the ring must be in the file, Run() reads any of them
+  if ((map_size_ - sizeof(Recording::Header)) / header_->record_size <
+      header_->capacity) {
+    header_ = nullptr;
+    error = path_ + ": truncated recording";
+    return false;
+  }
+  return true;
+}
+
+// DONE: Start playing on a background thread
+void Replayer::Start() {
+  if (!thread_.joinable() && header_ != nullptr) {
+    stop_ = false;
+    Open();
+    thread_ = std::thread(&Replayer::Run, this);
+  }
+}
+
+// DONE: Stop playing, the last snapshot stays available
+void Replayer::Stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  Close();  // also releases a lossless Publish() nobody will take
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+// DONE: Reorder the rows on screen right away
+// The replay thread re-publishes, so a re-sorted record can never overtake
+// the one after it.
+void Replayer::SortBy(SortKey key) {
+  key_.store(key);
+  {
+    std::lock_guard lock(mutex_);
+    resort_ = true;
+  }
+  wake_.notify_all();
+}
+
+// DONE: Return the key rows are ordered by
+SortKey Replayer::Key() const { return key_.load(); }
+
+// DONE: Return how many rows each record holds
+std::size_t Replayer::Rows() const {
+  return header_ == nullptr ? 0 : header_->rows_per_record;
+}
+
+void Replayer::Run() {
+  std::uint64_t written = header_->written;
+  std::uint64_t count = std::min<std::uint64_t>(written, header_->capacity);
+  long long time_ms = header_->base_time_ms;
+  long uptime = header_->base_uptime;
+  long total_processes = header_->base_total_processes;
+  auto due = std::chrono::steady_clock::now();
+  for (std::uint64_t index = written - count; index < written; ++index) {
+    Recording::Record const* record = RecordAt(index % header_->capacity);
+    time_ms += record->time_delta_ms;
+    uptime += record->uptime_delta;
+    total_processes += record->total_processes_delta;
+
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->time_ms = time_ms;
+    snapshot->operating_system = header_->operating_system;
+    snapshot->kernel = header_->kernel;
+    snapshot->cpu = record->cpu;
+    snapshot->memory = record->memory;
+    snapshot->total_processes = static_cast<int>(total_processes);
+    snapshot->running_processes = record->running_processes;
+    snapshot->uptime = uptime;
+    auto const* rows = reinterpret_cast<Recording::Row const*>(record + 1);
+    // A corrupt count must not read past the record
+    std::size_t count_rows =
+        std::min<std::size_t>(record->rows, header_->rows_per_record);
+    for (std::size_t i = 0; i < count_rows; ++i) {
+      ProcessRow& row = snapshot->processes.emplace_back();
+      row.pid = rows[i].pid;
+      row.cpu = rows[i].cpu;
+      row.rss = rows[i].ram_mb * 1024L;  // recorded in whole MB
+      row.ram = std::to_string(rows[i].ram_mb);
+      row.uptime = rows[i].time;
+      row.user.assign(rows[i].user,
+                      strnlen(rows[i].user, sizeof(rows[i].user)));
+      row.command.assign(rows[i].command,
+                         strnlen(rows[i].command, sizeof(rows[i].command)));
+    }
+
+    if (speed_ > 0 && index != written - count) {
+      due += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double, std::milli>(record->time_delta_ms /
+                                                    speed_));
+      if (!Wait(due)) return;
+    } else if (std::lock_guard lock(mutex_); stop_) {
+      return;
+    }
+    Sort(*snapshot);  // after the wait, the key may have changed during it
+    snapshot->epoch = ++epoch_;
+    last_ = snapshot;
+    Publish(std::move(snapshot));
+  }
+  Close();
+  // The last record stays on screen and can still be re-sorted
+  Wait(std::chrono::steady_clock::time_point::max());
+}
+
+// Sleep until due, re-publishing the last record whenever the key changes
+// False once stopped
+bool Replayer::Wait(std::chrono::steady_clock::time_point due) {
+  std::unique_lock lock(mutex_);
+  while (wake_.wait_until(lock, due, [this] { return stop_ || resort_; })) {
+    if (stop_) return false;
+    resort_ = false;
+    lock.unlock();
+    if (last_ != nullptr) {
+      auto snapshot = std::make_shared<Snapshot>(*last_);
+      Sort(*snapshot);
+      snapshot->epoch = ++epoch_;
+      last_ = snapshot;
+      Publish(std::move(snapshot));
+    }
+    lock.lock();
+  }
+  return true;
+}
+
+Recording::Record const* Replayer::RecordAt(std::size_t slot) const {
+  char const* records =
+      static_cast<char const*>(map_) + sizeof(Recording::Header);
+  return reinterpret_cast<Recording::Record const*>(
+      records + slot * header_->record_size);
+}
+
+// Age was not recorded, rows keep their recorded order for it
+void Replayer::Sort(Snapshot& snapshot) const {
+  SortKey key = key_.load();
+  snapshot.key = key;
+  auto value = [key](ProcessRow const& row) -> double {
+    switch (key) {
+      case SortKey::kCpu:
+        return row.cpu;
+      case SortKey::kRam:
+        return std::atof(row.ram.c_str());
+      case SortKey::kCpuTime:
+        return row.uptime;
+      case SortKey::kPid:
+        return -row.pid;
+      case SortKey::kAge:
+        break;
+    }
+    return 0;
+  };
+  std::stable_sort(snapshot.processes.begin(), snapshot.processes.end(),
+                   [&](ProcessRow const& a, ProcessRow const& b) {
+                     return value(a) > value(b);
+                   });
+}
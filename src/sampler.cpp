@@ -0,0 +1,164 @@
+#include "sampler.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "process.h"
+#include "process_table.h"
+#include "ranking.h"
+#include "recorder.h"
+#include "snapshot.h"
+#include "system.h"
+
+Sampler::Sampler(System& system, std::chrono::milliseconds period,
+                 std::size_t rows, SortKey key, unsigned fields)
+    : system_(system),
+      period_(period),
+      rows_(rows),
+      key_(key),
+      fields_(fields) {}
+
+Sampler::~Sampler() { Stop(); }
+
+// DONE: Start sampling on the background thread
+void Sampler::Start() {
+  if (!thread_.joinable()) {
+    stop_ = false;
+    Open();
+    thread_ = std::thread(&Sampler::Run, this);
+  }
+}
+
+// DONE: Stop sampling, waits for a pass in progress to finish
+void Sampler::Stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  Close();
+}
+
+// DONE: Change the sort key, re-ranks the last sample right away
+void Sampler::SortBy(SortKey key) {
+  key_.store(key);
+  {
+    std::lock_guard lock(mutex_);
+    resort_ = true;
+  }
+  wake_.notify_all();
+}
+
+// DONE: Return the key the process rows are ranked by
+SortKey Sampler::Key() const { return key_.load(); }
+
+// DONE: Return how many process rows each snapshot holds
+std::size_t Sampler::Rows() const { return rows_; }
+
+// DONE: Append every sampled snapshot to recorder, nullptr turns it off
+// Call before Start(), the recorder is used from the sampler thread only.
+void Sampler::RecordTo(Recorder* recorder) { recorder_ = recorder; }
+
+void Sampler::Run() {
+  auto next = std::chrono::steady_clock::now();
+  std::unique_lock lock(mutex_);
+  while (!stop_) {
+    lock.unlock();
+    Sample(true);
+    lock.lock();
+    next += period_;
+    auto now = std::chrono::steady_clock::now();
+    if (next < now) {
+      next += ((now - next) / period_ + 1) * period_;
+    }
+    while (wake_.wait_until(lock, next, [this] { return stop_ || resort_; })) {
+      if (stop_) return;
+      resort_ = false;
+      lock.unlock();
+      Sample(false);
+      lock.lock();
+    }
+  }
+}
+
+// DONE: List the busiest threads of a process under its row
+// Single-threaded processes and threads not read yet are left out.
+void Sampler::AddThreads(ProcessRow const& process, Snapshot& snapshot) {
+  std::vector<Process> const& threads = system_.Threads(process.pid);
+  if (threads.size() < 2) return;
+  Ranking::Top(threads, rows_, SortKey::kCpu, threads_);
+  int tgid = process.pid;
+  std::string user = process.user;  // the row moves as rows are added
+  for (Process const& thread : threads_) {
+    if (thread.Stat().comm[0] == '\0') continue;
+    ProcessRow& row = snapshot.processes.emplace_back();
+    row.pid = thread.Pid();
+    row.tgid = tgid;
+    row.user = user;
+    row.cpu = thread.CpuUtilization();
+    row.uptime = thread.UpTime();
+    row.command = thread.Stat().comm;
+  }
+}
+
+// DONE: Build and publish a snapshot
+// A resort keeps the last sample's counters and only ranks again, so the
+// CPU deltas still span a whole period.
+void Sampler::Sample(bool resample) {
+  SortKey key = key_.load();
+  auto snapshot = std::make_shared<Snapshot>();
+  std::vector<ProcessTable::Slot> const* slots{nullptr};
+  if (resample || last_ == nullptr) {
+    system_.Refresh();
+    snapshot->time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    snapshot->operating_system = system_.OperatingSystem();
+    snapshot->kernel = system_.Kernel();
+    snapshot->cpu = system_.Cpu().Utilization();
+    snapshot->cores = system_.Cpu().Cores();
+    snapshot->memory = system_.MemoryUtilization();
+    snapshot->memory_info = system_.Memory();
+    snapshot->total_processes = system_.TotalProcesses();
+    snapshot->running_processes = system_.RunningProcesses();
+    snapshot->uptime = system_.UpTime();
+    slots = &system_.Processes(rows_, key);
+    if (fields_ & kThreadsField) system_.UpdateThreads(*slots);
+  } else {
+    *snapshot = *last_;
+    snapshot->processes.clear();
+    slots = &system_.Rank(rows_, key);
+  }
+  snapshot->epoch = ++epoch_;
+  snapshot->key = key;
+  snapshot->processes.reserve(slots->size());
+  {
+    MONITOR_PHASE(kResolve);
+    ProcessTable& table = system_.Table();
+    for (ProcessTable::Slot slot : *slots) {
+      ProcessRow& row = snapshot->processes.emplace_back();
+      // Only the shown rows pay for the selected fields, see FieldSources
+      table.Load(slot, fields_, row);
+      if (fields_ & kThreadsField) AddThreads(row, *snapshot);
+    }
+  }
+  if (resample) {
+    Instrumentation::Totals totals = Instrumentation::Now();
+    snapshot->stats = Instrumentation::Delta(totals, totals_);
+    totals_ = totals;
+  }
+  last_ = snapshot;
+  if (resample && recorder_ != nullptr) {
+    recorder_->Append(*snapshot);
+  }
+  Publish(std::move(snapshot));
+}
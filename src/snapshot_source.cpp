@@ -0,0 +1,59 @@
+#include "snapshot_source.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "snapshot.h"
+
+// DONE: Return the newest snapshot, nullptr until the first one is out
+std::shared_ptr<Snapshot const> SnapshotSource::Latest() const {
+  return std::atomic_load(&latest_);
+}
+
+// DONE: Wait for a snapshot newer than epoch, nullptr once closed
+std::shared_ptr<Snapshot const> SnapshotSource::Next(unsigned long epoch) {
+  std::unique_lock lock(mutex_);
+  published_.wait(lock,
+                  [&] { return closed_ || published_epoch_ > epoch; });
+  if (published_epoch_ <= epoch) {
+    return nullptr;
+  }
+  taken_epoch_ = published_epoch_;
+  taken_.notify_all();
+  return Latest();
+}
+
+void SnapshotSource::Lossless(bool lossless) {
+  std::lock_guard lock(mutex_);
+  lossless_ = lossless;
+}
+
+// DONE: Make snapshot the latest one and wake whoever waits in Next()
+void SnapshotSource::Publish(std::shared_ptr<Snapshot const> snapshot) {
+  unsigned long epoch = snapshot->epoch;
+  {
+    std::unique_lock lock(mutex_);
+    taken_.wait(lock, [this] {
+      return !lossless_ || closed_ || taken_epoch_ >= published_epoch_;
+    });
+    std::atomic_store(&latest_, std::move(snapshot));
+    published_epoch_ = epoch;
+  }
+  published_.notify_all();
+}
+
+void SnapshotSource::Open() {
+  std::lock_guard lock(mutex_);
+  closed_ = false;
+}
+
+// DONE: No more snapshots are coming, Next() returns what it has
+void SnapshotSource::Close() {
+  {
+    std::lock_guard lock(mutex_);
+    closed_ = true;
+  }
+  published_.notify_all();
+  taken_.notify_all();
+}
@@ -0,0 +1,44 @@
+#include "string_pool.h"
+
+#include <cstddef>
+#include <string_view>
+
+StringPool::StringPool() : entries_(1) {}
+
+// DONE: Return the id of text, storing it on first use
+StringPool::Id StringPool::Intern(std::string_view text) {
+  if (text.empty()) return 0;
+  auto found = ids_.find(text);
+  if (found != ids_.end()) {
+    ++entries_[found->second].references;
+    return found->second;
+  }
+  Id id;
+  if (free_.empty()) {
+    id = static_cast<Id>(entries_.size());
+    entries_.emplace_back();
+  } else {
+    id = free_.back();
+    free_.pop_back();
+  }
+  Entry& entry = entries_[id];
+  entry.text.assign(text);
+  entry.references = 1;
+  ids_.emplace(entry.text, id);
+  return id;
+}
+
+// DONE: Drop a reference, the last one frees the string
+void StringPool::Release(Id id) {
+  if (id == 0) return;
+  Entry& entry = entries_[id];
+  if (--entry.references > 0) return;
+  ids_.erase(entry.text);
+  entry.text.clear();
+  entry.text.shrink_to_fit();
+  free_.push_back(id);
+}
+
+std::string_view StringPool::View(Id id) const { return entries_[id].text; }
+
+std::size_t StringPool::Size() const { return ids_.size(); }
@@ -1,66 +1,135 @@
 #include "system.h"
 
-#include <unistd.h>
-
 #include <cstddef>
-#include <map>
-#include <set>
 #include <string>
 #include <vector>
 
+#include "instrumentation.h"
 #include "linux_parser.h"
+#include "pid_directory.h"
+#include "proc_file.h"
 #include "process.h"
+#include "process_table.h"
 #include "processor.h"
+#include "thread_table.h"
+#include "worker_pool.h"
 
-System::System() {
+System::System(std::size_t workers)
+    : stat_file_(LinuxParser::ProcDirectory() + LinuxParser::kStatFilename),
+      meminfo_file_(LinuxParser::ProcDirectory() +
+                    LinuxParser::kMeminfoFilename),
+      uptime_file_(LinuxParser::ProcDirectory() + LinuxParser::kUptimeFilename),
+      loadavg_file_(LinuxParser::ProcDirectory() +
+                    LinuxParser::kLoadavgFilename),
+      pid_directory_(LinuxParser::ProcDirectory()),
+      pool_(workers) {
   kernel_ = LinuxParser::Kernel();
   operating_system_ = LinuxParser::OperatingSystem();
 }
 
+// DONE: Take this tick's /proc/stat snapshot, shared by every counter below
+// /proc/stat, /proc/meminfo, /proc/uptime and /proc/loadavg stay open,
+// see ProcFile
+void System::Refresh() {
+  if (LinuxParser::Stat(stat_file_.Read(), stat_)) {
+    cpu_.Update(stat_.cpu);
+    cpu_.Update(stat_.cores);
+  }
+  LinuxParser::Memory(meminfo_file_.Read(), memory_);
+  uptime_ = LinuxParser::UpTime(uptime_file_.Read());
+  last_pid_ = LinuxParser::LastPid(loadavg_file_.Read());
+}
+
 // DONE: Return the system's CPU
 Processor& System::Cpu() { return cpu_; }
 
 // DONE: Return a container composed of the system's processes
-std::vector<Process>& System::Processes() {
-  std::vector<int> pids{LinuxParser::Pids()};
-  // Unique pid's
-  std::set<int> unique_pids;
-  for (auto const& process : processes_) {
-    unique_pids.insert(process.Pid());
+// Only the n best ranked by key are kept, best first
+std::vector<ProcessTable::Slot> const& System::Processes(std::size_t n,
+                                                         SortKey key) {
+  {
+    MONITOR_PHASE(kEnumerate);
+    pid_directory_.Read(pids_);
   }
-
-  // Emplace all new processes
-  for (int pid : pids) {
-    if (unique_pids.find(pid) == unique_pids.end()) {
-      processes_.emplace_back(pid);
-    }
+  {
+    MONITOR_PHASE(kParse);
+    // One timebase for every process of the tick, taken right before
+    // their stat files are read
+    ProcessTable::Activity activity;
+    activity.busy_ticks = stat_.cpu.Busy();
+    activity.last_pid = last_pid_;
+    table_.Update(pids_, LinuxParser::BootTime(), activity, pool_);
   }
+  return Rank(n, key);
+}
 
-  // Update CPU utilization
-  for (auto& process : processes_) {
-    process.CpuUtilization(LinuxParser::ActiveJiffies(process.Pid()),
-                           LinuxParser::Jiffies());
-  }
-  std::sort(processes_.begin(), processes_.end(), std::greater<Process>());
-  return processes_;
+// DONE: Re-rank the processes of the last update without sampling again
+std::vector<ProcessTable::Slot> const& System::Rank(std::size_t n,
+                                                    SortKey key) {
+  MONITOR_PHASE(kRank);
+  table_.Prepare(key);
+  table_.Top(n, key, top_);
+  // Whatever is shown stays fresh however idle it is
+  table_.Hot(top_);
+  return top_;
+}
+
+// DONE: Return the processes of the last update, ex.: to resolve the slots
+// Processes() returned
+ProcessTable& System::Table() { return table_; }
+
+// DONE: Return how many processes appeared since the previous tick
+int System::ProcessesAdded() const { return table_.Added(); }
+
+// DONE: Return how many processes exited since the previous tick
+int System::ProcessesReaped() const { return table_.Reaped(); }
+
+// DONE: Read the threads of these processes, ex.: the ranked ones
+void System::UpdateThreads(std::vector<ProcessTable::Slot> const& slots) {
+  MONITOR_PHASE(kParse);
+  threads_.Update(table_, slots, LinuxParser::BootTime());
+}
+
+// DONE: Return the threads of a process as of the last UpdateThreads
+std::vector<Process> const& System::Threads(int pid) const {
+  return threads_.Threads(pid);
 }
 
+// DONE: Set how many thread stats one tick may read
+void System::ThreadBudget(std::size_t reads) { threads_.Budget(reads); }
+
+// DONE: Return how many processes were read by the last tick
+int System::ProcessesSampled() const { return table_.Sampled(); }
+
+// DONE: Show only the processes of this user, empty shows all
+void System::Filter(std::string const& user) { table_.Filter(user); }
+
+// DONE: Set how many ticks an idle process may go unsampled
+void System::MaxBackoff(unsigned ticks) { table_.MaxBackoff(ticks); }
+
 // DONE: Return the system's kernel identifier (string)
 std::string System::Kernel() const { return kernel_; }
 
 // DONE: Return the system's memory utilization
-float System::MemoryUtilization() const {
-  return LinuxParser::MemoryUtilization();
-}
+float System::MemoryUtilization() const { return memory_.Utilization(); }
+
+// DONE: Return the last /proc/meminfo figures, in kB
+LinuxParser::MemInfo const& System::Memory() const { return memory_; }
 
 // DONE: Return the operating system name
 std::string System::OperatingSystem() const { return operating_system_; }
 
 // DONE: Return the number of processes actively running on the system
-int System::RunningProcesses() { return LinuxParser::RunningProcesses(); }
+int System::RunningProcesses() const { return stat_.procs_running; }
+
+// DONE: Return the number of processes blocked waiting for I/O
+int System::BlockedProcesses() const { return stat_.procs_blocked; }
+
+// DONE: Return the number of context switches since boot
+long System::ContextSwitches() const { return stat_.context_switches; }
 
 // DONE: Return the total number of processes on the system
-int System::TotalProcesses() { return LinuxParser::TotalProcesses(); }
+int System::TotalProcesses() const { return stat_.processes; }
 
 // DONE: Return the number of seconds since the system started running
-long int System::UpTime() { return LinuxParser::UpTime(); }
+long int System::UpTime() const { return uptime_; }
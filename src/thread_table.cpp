@@ -0,0 +1,105 @@
+#include "thread_table.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linux_parser.h"
+#include "pid_directory.h"
+#include "process.h"
+#include "process_table.h"
+
+// DONE: Follow the threads of these processes, forget all others
+// The budget is shared out in order: each process gets an equal part of
+// what is left, so what a small one does not use goes to the next.
+void ThreadTable::Update(ProcessTable const& table,
+                         std::vector<ProcessTable::Slot> const& slots,
+                         long long boot_ns) {
+  ++generation_;
+  std::size_t reads = budget_;
+  std::size_t left = slots.size();
+  for (ProcessTable::Slot slot : slots) {
+    int pid = table.Pid(slot);
+    Group& group = groups_[pid];
+    if (group.tasks == nullptr || group.starttime != table.StartTime(slot)) {
+      group = Group{};
+      group.starttime = table.StartTime(slot);
+      group.tasks = std::make_unique<PidDirectory>(
+          LinuxParser::ProcDirectory() + std::to_string(pid) +
+              LinuxParser::kTaskDirectory,
+          16 << 10);
+    }
+    group.followed = generation_;
+    List(group);
+    reads -= Read(pid, group, reads / left--, boot_ns);
+  }
+  for (auto group = groups_.begin(); group != groups_.end();) {
+    if (group->second.followed == generation_) {
+      ++group;
+    } else {
+      group = groups_.erase(group);
+    }
+  }
+}
+
+// Diff the task directory against the group, exited threads are dropped
+void ThreadTable::List(Group& group) {
+  group.tasks->Read(group.tids);
+  for (int tid : group.tids) {
+    auto slot = group.slots.find(tid);
+    if (slot == group.slots.end()) {
+      group.slots.emplace(tid, group.threads.size());
+      group.threads.emplace_back(tid);
+      group.seen.push_back(generation_);
+    } else {
+      group.seen[slot->second] = generation_;
+    }
+  }
+  for (std::size_t slot = 0; slot < group.threads.size();) {
+    if (group.seen[slot] == generation_) {
+      ++slot;
+      continue;
+    }
+    group.slots.erase(group.threads[slot].Pid());
+    std::size_t last = group.threads.size() - 1;
+    if (slot != last) {
+      group.threads[slot] = std::move(group.threads[last]);
+      group.seen[slot] = group.seen[last];
+      group.slots[group.threads[slot].Pid()] = slot;
+    }
+    group.threads.pop_back();
+    group.seen.pop_back();
+  }
+}
+
+// Read up to reads threads from the cursor on, returns how many were read
+std::size_t ThreadTable::Read(int pid, Group& group, std::size_t reads,
+                              long long boot_ns) {
+  std::size_t count = std::min(reads, group.threads.size());
+  LinuxParser::PidStat stat;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (group.cursor >= group.threads.size()) group.cursor = 0;
+    Process& thread = group.threads[group.cursor++];
+    if (!LinuxParser::Stat(pid, thread.Pid(), stat)) continue;
+    // Tid reused since the last read, by a thread that exited in between
+    if (thread.Stat().comm[0] != '\0' &&
+        thread.Stat().starttime != stat.starttime) {
+      thread = Process(thread.Pid());
+    }
+    thread.Update(stat, boot_ns);
+  }
+  return count;
+}
+
+// DONE: Set how many thread stats one update may read
+void ThreadTable::Budget(std::size_t reads) { budget_ = reads; }
+
+// DONE: Return the threads of a process, in no particular order
+std::vector<Process> const& ThreadTable::Threads(int pid) const {
+  static std::vector<Process> const kNone;
+  auto group = groups_.find(pid);
+  return group == groups_.end() ? kNone : group->second.threads;
+}
@@ -0,0 +1,91 @@
+#include "user_cache.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "proc_file.h"
+#include "scanner.h"
+
+UserCache::UserCache(std::string path,
+                     std::chrono::milliseconds check_interval)
+    : path_(std::move(path)), check_interval_(check_interval) {
+  Reload();
+}
+
+// DONE: Return the user name of uid, or the uid itself when it has none
+std::string UserCache::Name(int uid) {
+  Reload();
+  std::shared_lock lock(mutex_);
+  auto found = std::lower_bound(
+      names_.begin(), names_.end(), uid,
+      [](auto const& entry, int value) { return entry.first < value; });
+  if (found != names_.end() && found->first == uid) {
+    return found->second;
+  }
+  return std::to_string(uid);
+}
+
+// DONE: Re-parse the file when its mtime moved, one thread at a time
+void UserCache::Reload() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+  auto next = next_check_.load(std::memory_order_relaxed);
+  if (now < next || !next_check_.compare_exchange_strong(
+                        next, now + check_interval_.count())) {
+    return;
+  }
+  struct stat info;
+  if (::stat(path_.c_str(), &info) != 0) {
+    return;
+  }
+  {
+    std::shared_lock lock(mutex_);
+    if (info.st_mtim.tv_sec == mtime_.tv_sec &&
+        info.st_mtim.tv_nsec == mtime_.tv_nsec) {
+      return;
+    }
+  }
+  if (Parse()) {
+    std::unique_lock lock(mutex_);
+    mtime_ = info.st_mtim;
+  }
+}
+
+// DONE: Parse name:password:uid:... lines into the sorted map
+// ex.: git:x:975:975:git daemon user:/:/usr/bin/git-shell
+bool UserCache::Parse() {
+  ProcFile file(path_, 64 << 10);
+  Scanner lines(file.Read());
+  if (lines.Empty()) {
+    return false;
+  }
+  std::vector<std::pair<int, std::string>> names;
+  while (!lines.Empty()) {
+    Scanner fields(lines.Line());
+    std::string_view name = fields.Until(':');
+    fields.Until(':');  // password
+    int uid{0};
+    if (!fields.Number(uid) || fields.Rest().substr(0, 1) != ":") continue;
+    names.emplace_back(uid, name);
+  }
+  // First entry wins for duplicated uids, like getpwuid(3)
+  std::stable_sort(
+      names.begin(), names.end(),
+      [](auto const& a, auto const& b) { return a.first < b.first; });
+  names.erase(std::unique(names.begin(), names.end(),
+                          [](auto const& a, auto const& b) {
+                            return a.first == b.first;
+                          }),
+              names.end());
+  std::unique_lock lock(mutex_);
+  names_ = std::move(names);
+  return true;
+}
@@ -0,0 +1,75 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+WorkerPool::WorkerPool(std::size_t size) {
+  for (std::size_t worker = 1; worker < std::max<std::size_t>(size, 1);
+       ++worker) {
+    threads_.emplace_back(&WorkerPool::Work, this, worker);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+// DONE: Return the number of workers, the calling thread included
+std::size_t WorkerPool::Size() const { return threads_.size() + 1; }
+
+// DONE: Shard [0, count) between all workers and wait for every chunk
+void WorkerPool::Run(std::size_t count, std::size_t chunk, Job const& job) {
+  if (threads_.empty() || count <= chunk) {
+    job(0, 0, count);
+    return;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    job_ = &job;
+    count_ = count;
+    chunk_ = std::max<std::size_t>(chunk, 1);
+    next_.store(0, std::memory_order_relaxed);
+    busy_ = threads_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+  Drain(0);
+  std::unique_lock lock(mutex_);
+  done_.wait(lock, [this] { return busy_ == 0; });
+  job_ = nullptr;
+}
+
+// DONE: Claim chunks until the range is exhausted
+void WorkerPool::Drain(std::size_t worker) {
+  for (std::size_t begin = next_.fetch_add(chunk_); begin < count_;
+       begin = next_.fetch_add(chunk_)) {
+    (*job_)(worker, begin, std::min(begin + chunk_, count_));
+  }
+}
+
+void WorkerPool::Work(std::size_t worker) {
+  unsigned long seen{0};
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+    }
+    Drain(worker);
+    {
+      std::lock_guard lock(mutex_);
+      --busy_;
+    }
+    done_.notify_one();
+  }
+}
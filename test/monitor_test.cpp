@@ -0,0 +1,160 @@
+// Regression checks for the monitor, run by ctest
+// A failed CHECK reports its line and the run exits non-zero at the end.
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+#include "process.h"
+#include "process_table.h"
+#include "processor.h"
+#include "worker_pool.h"
+
+namespace {
+int failures{0};
+
+#define CHECK(condition)                                            \
+  do {                                                              \
+    if (!(condition)) {                                             \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,   \
+                   __LINE__, #condition);                           \
+      ++failures;                                                   \
+    }                                                               \
+  } while (false)
+
+// One core with these active (user) and idle/iowait jiffies
+LinuxParser::CoreTimes Core(long user, long idle, long iowait) {
+  LinuxParser::CoreTimes cores;
+  cores.count = 1;
+  for (auto& column : cores.states) column.assign(1, 0);
+  cores.states[LinuxParser::kUser_][0] = user;
+  cores.states[LinuxParser::kIdle_][0] = idle;
+  cores.states[LinuxParser::kIOwait_][0] = iowait;
+  return cores;
+}
+
+// iowait is known to step back, the shares must stay in [0, 1]
+void TestCoreCountersStepBack() {
+  Processor processor;
+  processor.Update(Core(1000, 5000, 500));
+  // iowait fell by more than the period, the idle delta is negative
+  processor.Update(Core(1010, 5002, 400));
+  float share = processor.Cores()[0];
+  CHECK(share >= 0.0f && share <= 1.0f);
+  // active fell too
+  processor.Update(Core(1005, 5010, 400));
+  share = processor.Cores()[0];
+  CHECK(share >= 0.0f && share <= 1.0f);
+
+  LinuxParser::CpuTimes times;
+  times.states[LinuxParser::kUser_] = 1000;
+  times.states[LinuxParser::kIOwait_] = 500;
+  processor.Update(times);
+  times.states[LinuxParser::kUser_] = 1100;
+  times.states[LinuxParser::kIOwait_] = 450;  // 100 active over 50 jiffies
+  processor.Update(times);
+  CHECK(processor.Utilization() >= 0.0f && processor.Utilization() <= 1.0f);
+}
+
+// A /proc tree of bare stat files under a temporary directory
+class Tree {
+ public:
+  Tree() {
+    char root[] = "/tmp/monitor-test-XXXXXX";
+    if (::mkdtemp(root) != nullptr) root_ = root;
+    proc_ = root_ + "/proc/";
+    ::mkdir(proc_.c_str(), 0755);
+  }
+  ~Tree() {
+    if (!root_.empty()) std::system(("rm -rf " + root_).c_str());
+  }
+
+  std::string const& Proc() const { return proc_; }
+
+  void Write(int pid, char const* comm, long utime, long long starttime) {
+    std::string directory = proc_ + std::to_string(pid);
+    ::mkdir(directory.c_str(), 0755);
+    if (FILE* file = std::fopen((directory + "/stat").c_str(), "w")) {
+      std::fprintf(file,
+                   "%d (%s) S 1 %d %d 0 -1 4194304 0 0 0 0 %ld 0 0 0 20 0 "
+                   "1 0 %lld 1000 10 0\n",
+                   pid, comm, pid, pid, utime, starttime);
+      std::fclose(file);
+    }
+  }
+
+ private:
+  std::string root_;
+  std::string proc_;
+};
+
+// Whether pid is among the n best by key, found is its slot
+bool Ranked(ProcessTable& table, int pid, std::size_t n, SortKey key,
+            ProcessTable::Slot& found) {
+  std::vector<ProcessTable::Slot> top;
+  table.Top(n, key, top);
+  for (ProcessTable::Slot slot : top) {
+    if (table.Pid(slot) == pid) {
+      found = slot;
+      return true;
+    }
+  }
+  return false;
+}
+
+// A backed-off process that starts using CPU, or a new process under a
+// backed-off pid, must show within one update
+void TestBackoffCatchesChanges() {
+  Tree tree;
+  LinuxParser::SetRoots(tree.Proc(), "/dev/null");
+  std::vector<int> pids;
+  for (int pid = 100; pid < 110; ++pid) {
+    tree.Write(pid, "idle", 10, 50);
+    pids.push_back(pid);
+  }
+  WorkerPool pool(1);
+  ProcessTable table;
+  ProcessTable::Activity activity;
+  activity.busy_ticks = 1000;
+  activity.last_pid = 200;
+  long long boot_ns{1'000'000'000'000};
+  auto update = [&] {
+    boot_ns += 1'000'000'000;
+    table.Update(pids, boot_ns, activity, pool);
+  };
+  for (int tick = 0; tick < 40; ++tick) update();
+  CHECK(table.Sampled() < 10);  // backed off
+
+  // Half a CPU over the next second, charged to the machine
+  tree.Write(105, "idle", 60, 50);
+  activity.busy_ticks += 50;
+  update();
+  ProcessTable::Slot slot;
+  CHECK(Ranked(table, 105, 1, SortKey::kCpu, slot) &&
+        table.CpuUtilization(slot) > 0);
+
+  // 107 exits and the pid comes around again, idle this time
+  for (int tick = 0; tick < 40; ++tick) update();
+  tree.Write(107, "reused", 0, 90000);
+  activity.last_pid = 107;  // wrapped past pid_max
+  update();
+  CHECK(Ranked(table, 107, 10, SortKey::kPid, slot) &&
+        table.StartTime(slot) == 90000 && table.Command(slot) == "[reused]");
+  LinuxParser::SetRoots(LinuxParser::kProcDirectory,
+                        LinuxParser::kPasswordPath);
+}
+}  // namespace
+
+int main() {
+  TestCoreCountersStepBack();
+  TestBackoffCatchesChanges();
+  if (failures > 0) {
+    std::fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Builds a synthetic /proc tree plus passwd file so the monitor can be run
+// against 100k processes on a laptop, ex.:
+//   fakeproc --root /tmp/fake --processes 100000 --ticks 0 --churn 500
+//   monitor --proc /tmp/fake/proc --passwd /tmp/fake/passwd
+// Everything is derived from --seed, so two runs produce the same tree.
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "proc_fixture.h"
+
+namespace {
+struct Settings {
+  ProcFixture::Settings fixture;
+  long ticks{-1};  // mutations after creating, 0 runs until killed,
+                   // -1 only creates the tree
+
+  bool Parse(int argc, char* argv[], std::string& error);
+  static std::string Usage(char const* program);
+};
+
+bool ParseNumber(char const* text, long& value) {
+  char* end{nullptr};
+  value = std::strtol(text, &end, 10);
+  return end != text && *end == '\0' && value >= 0;
+}
+
+bool Settings::Parse(int argc, char* argv[], std::string& error) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view flag{argv[i]};
+    if (i + 1 == argc) {
+      error = "unknown or incomplete option " + std::string(flag);
+      return false;
+    }
+    char const* value = argv[++i];
+    bool valid{true};
+    if (flag == "--root") {
+      fixture.root = value;
+    } else if (flag == "--processes") {
+      valid = ParseNumber(value, fixture.processes) &&
+              fixture.processes > 0;
+    } else if (flag == "--cores") {
+      valid = ParseNumber(value, fixture.cores) && fixture.cores > 0;
+    } else if (flag == "--cmdline") {
+      valid = ParseNumber(value, fixture.cmdline);
+    } else if (flag == "--users") {
+      valid = ParseNumber(value, fixture.users);
+    } else if (flag == "--churn") {
+      valid = ParseNumber(value, fixture.churn);
+    } else if (flag == "--busy") {
+      valid = ParseNumber(value, fixture.busy) && fixture.busy <= 100;
+    } else if (flag == "--ticks") {
+      valid = ParseNumber(value, ticks);
+    } else if (flag == "--interval") {
+      valid =
+          ParseNumber(value, fixture.interval) && fixture.interval > 0;
+    } else if (flag == "--seed") {
+      valid = ParseNumber(value, fixture.seed);
+    } else {
+      error = "unknown option " + std::string(flag);
+      return false;
+    }
+    if (!valid) {
+      error = "invalid value " + std::string(value) + " for " +
+              std::string(flag);
+      return false;
+    }
+  }
+  if (fixture.root.empty()) {
+    error = "--root is required";
+    return false;
+  }
+  return true;
+}
+
+std::string Settings::Usage(char const* program) {
+  return std::string("usage: ") + program +
+         " --root DIR [options]\n"
+         "  --root DIR        writes DIR/proc and DIR/passwd\n"
+         "  --processes N     processes in the tree (default 1000)\n"
+         "  --cores N         cpuN rows in proc/stat (default 4)\n"
+         "  --cmdline N       average cmdline length (default 64)\n"
+         "  --users N         passwd entries besides root (default 50)\n"
+         "  --churn N         processes replaced per tick (default 0)\n"
+         "  --busy PCT        processes using CPU per tick (default 10)\n"
+         "  --ticks N         mutate the tree N times, 0 until killed\n"
+         "                    (default: only create it)\n"
+         "  --interval MS     time between mutations (default 1000)\n"
+         "  --seed N          random seed (default 1)\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Settings settings;
+  std::string error;
+  if (!settings.Parse(argc, argv, error)) {
+    std::cerr << error << "\n" << Settings::Usage(argv[0]);
+    return 2;
+  }
+
+  ProcFixture tree(settings.fixture);
+  if (!tree.Create()) {
+    std::cerr << "cannot write " << settings.fixture.root << ": "
+              << std::strerror(errno) << "\n";
+    return 1;
+  }
+  std::cerr << tree.Size() << " processes in " << tree.ProcDirectory()
+            << "\n";
+
+  auto due = std::chrono::steady_clock::now();
+  for (long tick = 0; settings.ticks == 0 || tick < settings.ticks; ++tick) {
+    due += std::chrono::milliseconds(settings.fixture.interval);
+    std::this_thread::sleep_until(due);
+    if (!tree.Tick()) {
+      std::cerr << "cannot update " << settings.fixture.root << ": "
+                << std::strerror(errno) << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,282 @@
+#include "proc_fixture.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace {
+long constexpr kTicksPerSecond{100};  // USER_HZ the tree pretends to run at
+int constexpr kPidMax{4194304};
+int constexpr kFirstPid{300};  // where the kernel restarts after wrapping
+
+// Per-pid files are replaced by rename() so a reader never sees half of one
+bool WriteFile(std::string const& path, std::string_view content) {
+  std::string temporary = path + ".tmp";
+  int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = ::write(fd, content.data(), content.size()) ==
+                 static_cast<ssize_t>(content.size());
+  ::close(fd);
+  return written && ::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// proc/stat, meminfo and uptime are rewritten in place instead: the monitor
+// keeps them open and pread()s the same inode every tick, like on /proc
+bool OverwriteFile(std::string const& path, std::string_view content) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = ::pwrite(fd, content.data(), content.size(), 0) ==
+                     static_cast<ssize_t>(content.size()) &&
+                 ::ftruncate(fd, content.size()) == 0;
+  ::close(fd);
+  return written;
+}
+}  // namespace
+
+ProcFixture::ProcFixture(Settings settings)
+    : settings_(std::move(settings)),
+      proc_(settings_.root + "/proc/"),
+      random_(settings_.seed),
+      cpus_(settings_.cores + 1),
+      used_(kPidMax + 1),
+      next_pid_(kFirstPid - 1) {}
+
+// DONE: Write the whole tree once
+bool ProcFixture::Create() {
+  std::error_code error;
+  std::filesystem::remove_all(proc_, error);
+  std::filesystem::create_directories(proc_, error);
+  if (error || !WritePasswd() ||
+      !WriteFile(proc_ + "version",
+                 "Linux version 6.1.0-fake (fake@fakeproc) (gcc 12.2.0) "
+                 "#1 SMP PREEMPT_DYNAMIC\n")) {
+    return false;
+  }
+  uptime_ms_ = 86400 * 1000L;
+  for (std::size_t core = 1; core < cpus_.size(); ++core) {
+    long elapsed = uptime_ms_ / 1000 * kTicksPerSecond;
+    cpus_[core][0] = elapsed / 20;
+    cpus_[core][2] = elapsed / 50;
+    cpus_[core][3] = elapsed - cpus_[core][0] - cpus_[core][2];
+  }
+  for (long i = 0; i < settings_.processes; ++i) {
+    if (!Spawn(i == 0 ? 1 : NextPid())) {
+      return false;
+    }
+  }
+  return WriteSystem();
+}
+
+// DONE: Advance the clock, hand out CPU time and replace churned processes
+bool ProcFixture::Tick() {
+  long elapsed = settings_.interval * kTicksPerSecond / 1000;
+  uptime_ms_ += settings_.interval;
+  running_ = 0;
+  std::uniform_int_distribution<long> share(0, elapsed);
+  std::uniform_int_distribution<long> percent(0, 99);
+  long user{0};
+  long system{0};
+  for (Process& process : processes_) {
+    if (percent(random_) >= settings_.busy) {
+      continue;
+    }
+    long utime = share(random_);
+    long stime = share(random_) / 4;
+    process.utime += utime;
+    process.stime += stime;
+    user += utime;
+    system += stime;
+    ++running_;
+    if (!WriteStat(process)) {
+      return false;
+    }
+  }
+  // The cores are charged what the processes were, like the kernel does
+  long cores = static_cast<long>(cpus_.size()) - 1;
+  for (std::size_t core = 1; core < cpus_.size(); ++core) {
+    std::array<long, kCpuStates>& cpu = cpus_[core];
+    long core_user = user / cores;
+    long core_system = system / cores;
+    cpu[0] += core_user;
+    cpu[2] += core_system;
+    cpu[3] += std::max(0L, elapsed - core_user - core_system);
+  }
+  for (long i = 0; i < settings_.churn && processes_.size() > 1; ++i) {
+    std::uniform_int_distribution<std::size_t> victim(
+        1, processes_.size() - 1);  // pid 1 never exits
+    if (!Reap(victim(random_)) || !Spawn(NextPid())) {
+      return false;
+    }
+  }
+  context_switches_ += running_ * 50 + 1000;
+  return WriteSystem();
+}
+
+std::size_t ProcFixture::Size() const { return processes_.size(); }
+
+std::string ProcFixture::ProcDirectory() const { return proc_; }
+
+std::string ProcFixture::PasswordPath() const {
+  return settings_.root + "/passwd";
+}
+
+int ProcFixture::NextPid() {
+  do {
+    next_pid_ = next_pid_ >= kPidMax ? kFirstPid : next_pid_ + 1;
+  } while (used_[next_pid_]);
+  return next_pid_;
+}
+
+bool ProcFixture::Spawn(int pid) {
+  std::uniform_int_distribution<long> user(0, settings_.users);
+  std::uniform_int_distribution<long> cmdline(settings_.cmdline / 2,
+                                              settings_.cmdline * 3 / 2);
+  std::uniform_int_distribution<long> rss(100, 100000);
+  std::uniform_int_distribution<long> threads(1, 64);
+  Process& process = processes_.emplace_back();
+  process.pid = pid;
+  process.ppid = pid == 1 ? 0 : 1;
+  long index = user(random_);  // 0 is root, then the passwd order
+  process.uid = index == 0 ? 0 : static_cast<int>(999 + index);
+  process.utime = 0;
+  process.stime = 0;
+  process.starttime = uptime_ms_ * kTicksPerSecond / 1000;
+  process.rss = rss(random_);
+  process.vsize = process.rss * 4096 * 3;
+  process.threads = threads(random_);
+  // Every 97th name exercises the parsers with ')' and spaces in comm
+  process.comm = pid % 97 == 0 ? "a) b (c" : "worker" + std::to_string(pid);
+  process.comm.resize(std::min<std::size_t>(process.comm.size(), 15));
+  process.cmdline = "/usr/lib/fake/" + process.comm;
+  for (long length = cmdline(random_);
+       static_cast<long>(process.cmdline.size()) < length;) {
+    process.cmdline += '\0';
+    process.cmdline += "--option=" + std::to_string(process.cmdline.size());
+  }
+  process.cmdline += '\0';
+  used_[pid] = true;
+  ++forks_;
+
+  std::string directory = proc_ + std::to_string(pid) + "/";
+  if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    return false;
+  }
+  return WriteStat(process) && WriteStatus(process) &&
+         WriteFile(directory + "cmdline", process.cmdline);
+}
+
+// Swap-and-pop, the order of processes_ carries no meaning
+bool ProcFixture::Reap(std::size_t index) {
+  int pid = processes_[index].pid;
+  processes_[index] = std::move(processes_.back());
+  processes_.pop_back();
+  used_[pid] = false;
+  std::error_code error;
+  std::filesystem::remove_all(proc_ + std::to_string(pid), error);
+  return !error;
+}
+
+// ex.: 1032 (kaccess) S 1014 1014 1014 0 -1 4194304 2464 25 11 0 2037 2332
+// 0 0 20 0 3 0 1984 298430464 3121 18446744073709551615 ...
+bool ProcFixture::WriteStat(Process const& process) {
+  char buffer[512];
+  int length = std::snprintf(
+      buffer, sizeof(buffer),
+      "%d (%s) S %d %d %d 0 -1 4194304 0 0 0 0 %ld %ld 0 0 20 0 %ld 0 %lld "
+      "%lu %ld 18446744073709551615 0 0 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0 "
+      "0 0 0 0 0 0 0 0\n",
+      process.pid, process.comm.c_str(), process.ppid, process.pid,
+      process.pid, process.utime, process.stime, process.threads,
+      process.starttime, process.vsize, process.rss);
+  return WriteFile(proc_ + std::to_string(process.pid) + "/stat",
+                   std::string_view(buffer, length));
+}
+
+bool ProcFixture::WriteStatus(Process const& process) {
+  char buffer[512];
+  int length = std::snprintf(
+      buffer, sizeof(buffer),
+      "Name:\t%s\nUmask:\t0022\nState:\tS (sleeping)\nTgid:\t%d\nNgid:\t0\n"
+      "Pid:\t%d\nPPid:\t%d\nUid:\t%d\t%d\t%d\t%d\nGid:\t%d\t%d\t%d\t%d\n"
+      "VmSize:\t%8lu kB\nVmRSS:\t%8lu kB\nThreads:\t%ld\n",
+      process.comm.c_str(), process.pid, process.pid, process.ppid,
+      process.uid, process.uid, process.uid, process.uid, process.uid,
+      process.uid, process.uid, process.uid, process.vsize / 1024,
+      process.rss * 4, process.threads);
+  return WriteFile(proc_ + std::to_string(process.pid) + "/status",
+                   std::string_view(buffer, length));
+}
+
+bool ProcFixture::WriteSystem() {
+  std::string stat;
+  for (std::size_t core = 0; core < cpus_.size(); ++core) {
+    std::array<long, kCpuStates>& cpu = cpus_[core];
+    if (core == 0) {
+      cpu.fill(0);
+      for (std::size_t other = 1; other < cpus_.size(); ++other) {
+        for (int state = 0; state < kCpuStates; ++state) {
+          cpu[state] += cpus_[other][state];
+        }
+      }
+      stat += "cpu ";
+    } else {
+      stat += "cpu" + std::to_string(core - 1);
+    }
+    for (long ticks : cpu) {
+      stat += ' ' + std::to_string(ticks);
+    }
+    stat += '\n';
+  }
+  stat += "intr 0\nctxt " + std::to_string(context_switches_) +
+          "\nbtime 1700000000\nprocesses " + std::to_string(forks_) +
+          "\nprocs_running " + std::to_string(std::max(1L, running_)) +
+          "\nprocs_blocked 0\n";
+
+  long total = 64L << 20;  // kB
+  long used = std::min(total, static_cast<long>(processes_.size()) * 64);
+  std::string meminfo =
+      "MemTotal:       " + std::to_string(total) +
+      " kB\nMemFree:        " + std::to_string(total - used) +
+      " kB\nMemAvailable:   " + std::to_string(total - used / 2) +
+      " kB\nBuffers:        " + std::to_string(used / 8) +
+      " kB\nCached:         " + std::to_string(used / 4) +
+      " kB\nSwapTotal:      0 kB\nSwapFree:       0 kB\n";
+
+  char uptime[64];
+  int length = std::snprintf(uptime, sizeof(uptime), "%ld.%02ld %ld.00\n",
+                             uptime_ms_ / 1000, uptime_ms_ % 1000 / 10,
+                             uptime_ms_ / 1000 * settings_.cores / 2);
+  // Load averages are not modelled, the last pid is what the monitor reads
+  std::string loadavg = "0.00 0.00 0.00 " + std::to_string(running_) + "/" +
+                        std::to_string(processes_.size()) + " " +
+                        std::to_string(next_pid_) + "\n";
+
+  return OverwriteFile(proc_ + "stat", stat) &&
+         OverwriteFile(proc_ + "loadavg", loadavg) &&
+         OverwriteFile(proc_ + "meminfo", meminfo) &&
+         OverwriteFile(proc_ + "uptime", std::string_view(uptime, length));
+}
+
+bool ProcFixture::WritePasswd() {
+  std::string passwd = "root:x:0:0:root:/root:/bin/bash\n";
+  for (long i = 0; i < settings_.users; ++i) {
+    std::string uid = std::to_string(1000 + i);
+    passwd += "user" + uid + ":x:" + uid + ":" + uid + "::/home/user" +
+              uid + ":/bin/sh\n";
+  }
+  return WriteFile(PasswordPath(), passwd);
+}
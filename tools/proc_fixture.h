@@ -0,0 +1,75 @@
+#ifndef PROC_FIXTURE_H
+#define PROC_FIXTURE_H
+
+#include <array>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+Synthetic /proc tree plus passwd file, ex.: ROOT/proc/42/stat, ROOT/passwd
+Everything is derived from the seed, so two fixtures with the same settings
+are identical. Used by the fakeproc tool and the benchmarks.
+*/
+class ProcFixture {
+ public:
+  struct Settings {
+    std::string root;
+    long processes{1000};
+    long cores{4};
+    long cmdline{64};  // average cmdline length in bytes
+    long users{50};    // passwd entries besides root
+    long churn{0};     // processes replaced per tick
+    long busy{10};     // percent of processes using CPU per tick
+    long interval{1000};  // ms the clock advances per tick
+    long seed{1};
+  };
+
+  explicit ProcFixture(Settings settings);
+  bool Create();
+  bool Tick();
+  std::size_t Size() const;
+  std::string ProcDirectory() const;
+  std::string PasswordPath() const;
+
+ private:
+  static int constexpr kCpuStates{10};  // user .. guest_nice in /proc/stat
+
+  struct Process {
+    int pid;
+    int ppid;
+    int uid;
+    long utime;
+    long stime;
+    long long starttime;
+    unsigned long vsize;  // bytes
+    long rss;             // pages
+    long threads;
+    std::string comm;
+    std::string cmdline;
+  };
+
+  int NextPid();
+  bool Spawn(int pid);
+  bool Reap(std::size_t index);
+  bool WriteStat(Process const& process);
+  bool WriteStatus(Process const& process);
+  bool WriteSystem();
+  bool WritePasswd();
+
+  Settings settings_;
+  std::string proc_;
+  std::mt19937_64 random_;
+  std::vector<Process> processes_;
+  std::vector<std::array<long, kCpuStates>> cpus_;  // [0] is the total
+  std::vector<bool> used_;                           // by pid
+  int next_pid_{0};
+  long uptime_ms_{0};
+  long running_{0};
+  long forks_{0};
+  long context_switches_{0};
+};
+
+#endif